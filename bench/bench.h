@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include "fmt/core.h"
+
+using namespace std;
+
+struct BenchResult {
+    string name;
+    int64_t iterations;
+    double seconds;
+    double bytes_per_iteration;
+
+    double nsPerIteration() const { return seconds * 1e9 / iterations; }
+    double mbPerSecond() const { return bytes_per_iteration * iterations / seconds / 1e6; }
+    double opsPerSecond() const { return iterations / seconds; }
+};
+
+// Every result of the run, written out by writeBenchJson
+inline vector<BenchResult> bench_results;
+
+// Keeps the optimizer from dropping the benchmarked work
+inline volatile int64_t bench_sink = 0;
+inline void doNotOptimize(int64_t value) {
+    bench_sink = value;
+}
+
+// Runs fn until min_seconds have passed and reports the mean time per call.
+// bytes_per_iteration is the input size used for the throughput column, 
+// when it is 0 the throughput is reported in calls per second.
+inline BenchResult runBench(const string& name, double bytes_per_iteration, const function<int64_t()>& fn, double min_seconds = 0.5) {
+    doNotOptimize(fn()); // warm up
+    int64_t iterations = 0;
+    auto start = chrono::steady_clock::now();
+    double seconds = 0.0;
+    while (seconds < min_seconds) {
+        doNotOptimize(fn());
+        iterations++;
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    BenchResult result = {name, iterations, seconds, bytes_per_iteration};
+    bench_results.push_back(result);
+    if (bytes_per_iteration > 0) {
+        fmt::print("{:<48} {:>12.0f} ns/op {:>10.1f} MB/s\n", name, result.nsPerIteration(), result.mbPerSecond());
+    } else {
+        fmt::print("{:<48} {:>12.0f} ns/op {:>10.1f} op/s\n", name, result.nsPerIteration(), result.opsPerSecond());
+    }
+    return result;
+}
+
+// One JSON object per benchmark, so runs can be diffed between commits
+inline void writeBenchJson(const string& path) {
+    ofstream file(path);
+    file << "[\n";
+    for (size_t i = 0; i < bench_results.size(); i++) {
+        const BenchResult& result = bench_results[i];
+        file << fmt::format("  {{\"name\": \"{}\", \"iterations\": {}, \"seconds\": {}, \"ns_per_op\": {}, \"bytes_per_op\": {}, \"ops_per_s\": {}}}{}\n",
+            result.name, result.iterations, result.seconds, result.nsPerIteration(), result.bytes_per_iteration, 
+            result.opsPerSecond(), i + 1 < bench_results.size() ? "," : "");
+    }
+    file << "]\n";
+}
+
+// Synthetic MPS files of increasing size, see mps_bench.cpp
+string writeSyntheticMps(int num_rows, int num_cols, int nnz_per_col);
@@ -0,0 +1,35 @@
+#include "bench.h"
+#include <cstring>
+
+void runCodecBenchmarks();
+void runSamplingBenchmarks();
+void runDbBenchmarks();
+void runMpsBenchmarks();
+void runModelBenchmarks();
+
+// solver-bench [--json <path>]
+int main(int argc, char** argv) {
+    string json_path;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json_path = argv[i + 1];
+        }
+    }
+
+    fmt::print("Solution codec\n");
+    runCodecBenchmarks();
+    fmt::print("\nSampling\n");
+    runSamplingBenchmarks();
+    fmt::print("\nStorage\n");
+    runDbBenchmarks();
+    fmt::print("\nMPS reader\n");
+    runMpsBenchmarks();
+    fmt::print("\nModel\n");
+    runModelBenchmarks();
+
+    if (!json_path.empty()) {
+        writeBenchJson(json_path);
+        fmt::print("\nWrote {} results to {}\n", bench_results.size(), json_path);
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "bench.h"
+#include "../src/solution_codec.h"
+#include "../src/utils.h"
+#include <random>
+
+using namespace std;
+
+// Solution encodings at increasing density: the legacy text path against the binary codec
+void runCodecBenchmarks() {
+    vector<int> sizes = {100000, 1000000};
+    vector<double> densities = {0.001, 0.01, 0.1, 0.5};
+    mt19937 rng(0);
+    for (int num_vars : sizes) {
+        for (double density : densities) {
+            vector<int> solution;
+            bernoulli_distribution is_one(density);
+            for (int i = 0; i < num_vars; i++) {
+                if (is_one(rng)) {
+                    solution.push_back(i);
+                }
+            }
+            double bytes = solution.size() * sizeof(int);
+            string label = fmt::format("n={} density={}", num_vars, density);
+
+            string text = convertVectorToString(solution);
+            vector<char> blob = encodeSolution(solution, num_vars);
+            fmt::print("{}: text {} bytes, blob {} bytes ({})\n", label, text.size(), blob.size(), 
+                getSolutionEncoding(blob) == SOLUTION_BITSET ? "bitset" : "delta varint");
+
+            runBench(fmt::format("text encode {}", label), bytes, [&]() {
+                return (int64_t)convertVectorToString(solution).size();
+            });
+            runBench(fmt::format("text decode {}", label), bytes, [&]() {
+                return (int64_t)parseSolutionString(text).size();
+            });
+            runBench(fmt::format("codec encode {}", label), bytes, [&]() {
+                return (int64_t)encodeSolution(solution, num_vars).size();
+            });
+            runBench(fmt::format("codec decode {}", label), bytes, [&]() {
+                return (int64_t)decodeSolution(blob).size();
+            });
+        }
+    }
+}
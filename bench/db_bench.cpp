@@ -0,0 +1,144 @@
+#include "bench.h"
+#include "../src/db.h"
+#include <filesystem>
+#include <random>
+
+using namespace std;
+
+static string benchDbPath(const string& name) {
+    string path = (filesystem::temp_directory_path() / fmt::format("solver-bench-{}.sqlite", name)).string();
+    filesystem::remove(path);
+    filesystem::remove(path + "-wal");
+    filesystem::remove(path + "-shm");
+    return path;
+}
+
+static GRBAttributes makeAttributes(mt19937& rng) {
+    GRBAttributes attributes = {
+        .MIPGap = 0.01,
+        .Runtime = 10.0,
+        .SolCount = 1,
+        .NodeCount = 1000,
+        .Status = 9,
+        .ObjVal = (double)(rng() % 100000),
+        .MaxMemUsed = 0.1,
+    };
+    attributes.solution_blob.resize(10000, 1);
+    return attributes;
+}
+
+static vector<CallbackMetric> makeMetrics(int count) {
+    vector<CallbackMetric> metrics(count);
+    for (int i = 0; i < count; i++) {
+        metrics[i] = {.non_zero_count = i, .phase = 1, .solcnt = 1, .elapsed_ms = i};
+    }
+    return metrics;
+}
+
+template <class S>
+static int64_t insertJob(S& storage, mt19937& rng, vector<CallbackMetric>& metrics) {
+    Job job = {.instance_id = fmt::format("instance_{}", rng() % 200), .group_name = "grb_only"};
+    int job_id = storage.insert(job);
+    GRBAttributes attributes = makeAttributes(rng);
+    attributes.job_id = job_id;
+    storage.insert(attributes);
+    for (auto& metric : metrics) {
+        metric.job_id = job_id;
+    }
+    storage.insert_range(metrics.begin(), metrics.end());
+    return job_id;
+}
+
+template <class S>
+static int64_t lookupBest(S& storage, const string& instance_id) {
+    auto results = storage.select(
+        object<GRBAttributes>(),
+        join<Job>(on(c(&GRBAttributes::job_id) == &Job::id)),
+        where(c(&Job::instance_id) == instance_id 
+            and (c(&GRBAttributes::solution) != "" or length(&GRBAttributes::solution_blob) > 0) 
+            and c(&Job::group_name) == "grb_only"),
+        order_by(&GRBAttributes::ObjVal).asc(),
+        limit(1)
+    );
+    return results.size();
+}
+
+// Connection per call with default journaling (previous behaviour) against 
+// one tuned connection with the job writes grouped in a transaction
+void runDbBenchmarks() {
+    mt19937 rng(0);
+    vector<CallbackMetric> metrics = makeMetrics(100);
+
+    string baseline_path = benchDbPath("baseline");
+    make_storage_at(baseline_path).sync_schema();
+    runBench("insert job, connection per statement", 0, [&]() {
+        Job job = {.instance_id = fmt::format("instance_{}", rng() % 200), .group_name = "grb_only"};
+        int job_id = make_storage_at(baseline_path).insert(job);
+        GRBAttributes attributes = makeAttributes(rng);
+        attributes.job_id = job_id;
+        make_storage_at(baseline_path).insert(attributes);
+        for (auto& metric : metrics) {
+            metric.job_id = job_id;
+        }
+        make_storage_at(baseline_path).insert_range(metrics.begin(), metrics.end());
+        return (int64_t)job_id;
+    });
+
+    string tuned_path = benchDbPath("tuned");
+    Storage tuned = make_storage_at(tuned_path);
+    tune_storage(tuned);
+    tuned.sync_schema();
+    runBench("insert job, persistent WAL + transaction", 0, [&]() {
+        int64_t job_id = 0;
+        tuned.transaction([&] {
+            job_id = insertJob(tuned, rng, metrics);
+            return true;
+        });
+        return job_id;
+    });
+
+    // Same data in both files, the baseline without the new indexes
+    for (int i = 0; i < 5000; i++) {
+        tuned.transaction([&] {
+            insertJob(tuned, rng, metrics);
+            return true;
+        });
+    }
+    filesystem::remove(baseline_path);
+    sqlite3* db;
+    sqlite3_open(tuned_path.c_str(), &db);
+    sqlite3_exec(db, fmt::format("VACUUM INTO '{}';", baseline_path).c_str(), nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+    sqlite3_open(baseline_path.c_str(), &db);
+    sqlite3_exec(db, 
+        "PRAGMA journal_mode=DELETE;"
+        "DROP INDEX jobs_instance_group_idx;"
+        "DROP INDEX grb_attributes_job_idx;", 
+        nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+
+    runBench("best solution lookup, new connection, no index", 0, [&]() {
+        auto storage = make_storage_at(baseline_path);
+        return lookupBest(storage, fmt::format("instance_{}", rng() % 200));
+    });
+    runBench("best solution lookup, persistent + index", 0, [&]() {
+        return lookupBest(tuned, fmt::format("instance_{}", rng() % 200));
+    });
+
+    // batch_insert_metrics writes through the process wide storage, which opens
+    // data/db.sqlite relative to the working directory
+    filesystem::path working_dir = filesystem::current_path();
+    filesystem::path bench_dir = filesystem::temp_directory_path() / "solver-bench-data";
+    filesystem::remove_all(bench_dir);
+    filesystem::create_directories(bench_dir / "data");
+    filesystem::current_path(bench_dir);
+    get_storage().sync_schema();
+    vector<CallbackMetric> callback_metrics = makeMetrics(10000);
+    for (int batch_size : {100, 1000, 10000}) {
+        runBench(fmt::format("batch_insert_metrics n=10000 batch={}", batch_size), 0, [&]() {
+            batch_insert_metrics(callback_metrics, batch_size);
+            return (int64_t)callback_metrics.size();
+        });
+    }
+    filesystem::current_path(working_dir);
+}
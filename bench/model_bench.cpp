@@ -0,0 +1,71 @@
+#include "bench.h"
+#include "../src/binary_variables.h"
+#include "../src/bound_fixer.h"
+#include "../src/grb_env.h"
+#include "../src/lns.h"
+#include "../src/utils.h"
+#include <filesystem>
+#include <memory>
+#include <random>
+
+using namespace std;
+
+// Gurobi side of an LNS job on synthetic models: reading the binary variables and
+// building the neighborhood, as a fixing row (applyLNS default) or through the bounds
+void runModelBenchmarks() {
+    unique_ptr<GRBEnv> env;
+    try {
+        env = GurobiEnvironment::createEnv(1, false);
+    } catch (GRBException& e) {
+        fmt::print("Skipping model benchmarks, no Gurobi environment: {}\n", e.getMessage());
+        return;
+    }
+
+    vector<int> sizes = {10000, 100000, 1000000};
+    double fixing_ratio = 0.8;
+    mt19937 rng(0);
+    for (int num_cols : sizes) {
+        string path = writeSyntheticMps(num_cols / 2, num_cols, 5);
+        GRBModel model(*env, path);
+        filesystem::remove(path);
+        string label = fmt::format("n={}", num_cols);
+
+        runBench(fmt::format("getBinaryVariables per variable {}", label), 0, [&]() {
+            unique_ptr<GRBVar[]> vars(model.getVars());
+            int64_t count = 0;
+            for (int j = 0; j < num_cols; j++) {
+                count += isBinary(vars[j]);
+            }
+            return count;
+        });
+        runBench(fmt::format("getBinaryVariables bulk {}", label), 0, [&]() {
+            return (int64_t)getBinaryVariables(model).size();
+        });
+
+        vector<GRBVar> binary_variables = getBinaryVariables(model);
+        int num_binary_variables = binary_variables.size();
+        vector<int> fixing_indices = sample_percentage(num_binary_variables, fixing_ratio, rng);
+        vector<double> solution(num_binary_variables);
+        for (double& value : solution) {
+            value = rng() % 2;
+        }
+        label = fmt::format("n={} ratio={}", num_cols, fixing_ratio);
+
+        runBench(fmt::format("fixing row add+remove {}", label), 0, [&]() {
+            GRBConstr constr = addFixingConstraint(model, binary_variables, solution, fixing_indices);
+            model.update();
+            model.remove(constr);
+            model.update();
+            return (int64_t)fixing_indices.size();
+        });
+        BoundFixer fixer(model, binary_variables);
+        runBench(fmt::format("bound fixing fix+restore {}", label), 0, [&]() {
+            // Like the LNS loops: the solve applies the fixings, the restore stays
+            // pending until the next fix
+            fixer.fix(fixing_indices, solution);
+            model.update();
+            fixer.restore();
+            return (int64_t)fixing_indices.size();
+        });
+    }
+}
@@ -0,0 +1,57 @@
+#include "bench.h"
+#include "../src/mps_reader.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace std;
+
+// Random set-covering style model with a mix of binary, integer and continuous columns
+string writeSyntheticMps(int num_rows, int num_cols, int nnz_per_col) {
+    string path = (filesystem::temp_directory_path() / fmt::format("solver-bench-{}x{}.mps", num_rows, num_cols)).string();
+    ofstream file(path);
+    mt19937 rng(0);
+    file << "NAME          SYNTHETIC\nROWS\n N  OBJ\n";
+    for (int i = 0; i < num_rows; i++) {
+        file << " G  R" << i << "\n";
+    }
+    file << "COLUMNS\n    MARKER                 'MARKER'                 'INTORG'\n";
+    int num_int_cols = num_cols * 3 / 4;
+    for (int j = 0; j < num_cols; j++) {
+        if (j == num_int_cols) {
+            file << "    MARKER                 'MARKER'                 'INTEND'\n";
+        }
+        file << "    C" << j << "  OBJ  " << (rng() % 100 + 1) << "\n";
+        for (int k = 0; k < nnz_per_col; k++) {
+            file << "    C" << j << "  R" << rng() % num_rows << "  " << (rng() % 10 + 1) << "\n";
+        }
+    }
+    file << "RHS\n";
+    for (int i = 0; i < num_rows; i++) {
+        file << "    RHS  R" << i << "  1\n";
+    }
+    file << "BOUNDS\n";
+    for (int j = 0; j < num_int_cols; j++) {
+        file << " UP BND  C" << j << "  " << (j % 3 == 0 ? 5 : 1) << "\n";
+    }
+    file << "ENDATA\n";
+    return path;
+}
+
+void runMpsBenchmarks() {
+    vector<pair<int, int>> sizes = {{1000, 10000}, {10000, 100000}, {50000, 500000}};
+    for (auto [num_rows, num_cols] : sizes) {
+        string path = writeSyntheticMps(num_rows, num_cols, 5);
+        double bytes = filesystem::file_size(path);
+        MpsCounts counts = countMps(path);
+        fmt::print("{}x{}: {:.1f} MB, {} nonzeros, {} binaries\n", 
+            num_rows, num_cols, bytes / 1e6, counts.num_nonzeros, counts.num_bin_vars);
+        runBench(fmt::format("countMps {}x{}", num_rows, num_cols), bytes, [&]() {
+            return (int64_t)countMps(path).num_nonzeros;
+        });
+        runBench(fmt::format("readMps with names {}x{}", num_rows, num_cols), bytes, [&]() {
+            return readMps(path).numNonzeros();
+        });
+        filesystem::remove(path);
+    }
+}
@@ -0,0 +1,54 @@
+#include "bench.h"
+#include "../src/sampler.h"
+#include "../src/utils.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+using namespace std;
+
+// Previous sample_without_replacement: shuffles a fresh copy of the whole population
+static vector<int> fullShuffleSample(int n, int sample_size, mt19937& rng) {
+    vector<int> population(n);
+    iota(population.begin(), population.end(), 0);
+    shuffle(population.begin(), population.end(), rng);
+    population.resize(sample_size);
+    return population;
+}
+
+// Fixing index sampling as done by every LNS iteration, over growing binary counts
+void runSamplingBenchmarks() {
+    vector<int> sizes = {1000, 10000, 100000, 1000000};
+    vector<double> ratios = {0.01, 0.05, 0.2, 0.8};
+    mt19937 rng(0);
+    Sampler sampler;
+    for (int n : sizes) {
+        for (double ratio : ratios) {
+            string label = fmt::format("n={} ratio={}", n, ratio);
+            int k = n * ratio;
+            runBench(fmt::format("full shuffle {}", label), 0, [&]() {
+                return (int64_t)fullShuffleSample(n, k, rng).size();
+            });
+            runBench(fmt::format("Sampler::sample {}", label), 0, [&]() {
+                return (int64_t)sampler.sample(n, k, rng).size();
+            });
+            // The seeded overload used by applyLNS also constructs the generator
+            runBench(fmt::format("sample_percentage seeded {}", label), 0, [&]() {
+                return (int64_t)sample_percentage(n, ratio, (int)(rng() % 1000)).size();
+            });
+        }
+
+        // Objective guided neighborhoods: skewed weights, 20% of the variables freed
+        vector<double> weights(n);
+        for (int i = 0; i < n; i++) {
+            weights[i] = i % 10 == 0 ? 1.0 + rng() % 100 : 0.01;
+        }
+        runBench(fmt::format("AliasTable build n={}", n), 0, [&]() {
+            return (int64_t)AliasTable(weights).numPositive();
+        });
+        AliasTable table(weights);
+        runBench(fmt::format("Sampler::sampleWeighted n={} ratio=0.2", n), 0, [&]() {
+            return (int64_t)sampler.sampleWeighted(table, n / 5, rng).size();
+        });
+    }
+}
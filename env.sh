@@ -15,6 +15,7 @@ alias run="./build/$PROJECT_NAME"
 alias brun="build && run"
 alias clean='rm -rf build'
 alias r="build && run -a"
+alias bench="build && ./build/solver-bench"
 
 
 # python scripts 
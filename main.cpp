@@ -5,6 +5,11 @@
 #include <fmt/ranges.h>
 #include "src/db.h"
 #include "src/solve_mps.h"
+#include "src/executor.h"
+#include "src/distributed.h"
+#include "src/trace.h"
+#include "src/model_cache.h"
+#include "src/neighborhood.h"
 
 using namespace std;
 
@@ -17,9 +22,20 @@ vector<Action> get_actions() {
     return {
         Action{"syncdb", []() { sync_db(); return 0; }},
         Action{"seed", []() { seed_instances(); return 0; }},
+        Action{"check_mps", []() { check_mps_reader(); return 0; }},
+        Action{"migrate_solutions", []() { migrate_solutions(); return 0; }},
         Action{"grb_only", []() { solveGRBOnly(); return 0; }},
         Action{"warm_start", []() { solveWarmStart(); return 0; }},
         Action{"lns", []() { solveLNS(); return 0; }},
+        Action{"lns_iter", []() { solveIterativeLNS(); return 0; }},
+        Action{"lns_fixing", []() { solveLNSFixingBenchmark(); return 0; }},
+        Action{"alns", []() { solveAdaptiveLNS(); return 0; }},
+        Action{"race", []() { solveRace(); return 0; }},
+        Action{"hybrid", []() { solveHybrid(); return 0; }},
+        Action{"stall", []() { solveStallBenchmark(); return 0; }},
+        Action{"pin_bench", []() { solvePinningBenchmark(); return 0; }},
+        Action{"neighborhood_bench", []() { benchmarkNeighborhoods(); return 0; }},
+        Action{"worker", []() { runWorker(getExecutorConfig().coordinator_address); return 0; }},
     };
 }
 
@@ -36,7 +52,21 @@ int main(int argc, char **argv) {
     cxxopts::Options options("Solver", "Example project to solve MPS files with Gurobi and LNS");
     options.add_options()("h,help", "Print usage")(
         "a,action", action_names_string,
-        cxxopts::value<string>());
+        cxxopts::value<string>())(
+        "w,workers", "Number of jobs solved concurrently",
+        cxxopts::value<int>()->default_value("1"))(
+        "threads-per-job", "Gurobi Threads per job (0 splits the cores between workers)",
+        cxxopts::value<int>()->default_value("0"))(
+        "model-cache-mb", "Memory budget of the parsed model cache (0 disables it)",
+        cxxopts::value<int>()->default_value("4096"))(
+        "lease-s", "Job lease in seconds, jobs of a process that stopped renewing it are run again",
+        cxxopts::value<int>()->default_value("60"))(
+        "pin", "Pin every worker and the Gurobi threads of its jobs to its own cores, within one NUMA node when possible",
+        cxxopts::value<bool>()->default_value("false"))(
+        "work-limit", "Limit jobs to this many Gurobi work units instead of seconds, deterministic whatever the number of workers",
+        cxxopts::value<double>()->default_value("0"))(
+        "coordinator", "unix:<path> or tcp:<host>:<port>, experiment actions serve their jobs there and the worker action solves them",
+        cxxopts::value<string>()->default_value(""));
 
     auto result = options.parse(argc, argv);
 
@@ -45,10 +75,21 @@ int main(int argc, char **argv) {
     return 0;
     }
 
+    ExecutorConfig& executor_config = getExecutorConfig();
+    executor_config.workers = result["workers"].as<int>();
+    executor_config.threads_per_job = result["threads-per-job"].as<int>();
+    executor_config.lease_s = result["lease-s"].as<int>();
+    executor_config.work_limit = result["work-limit"].as<double>();
+    executor_config.pin_cpus = result["pin"].as<bool>();
+    executor_config.coordinator_address = result["coordinator"].as<string>();
+    ModelCache::getInstance().setCapacityMB(result["model-cache-mb"].as<int>());
+
     if (result.count("action")) {
         auto action = result["action"].as<string>();
         if (action_map.find(action) != action_map.end()) {
-            return action_map[action]();
+            int code = action_map[action]();
+            TRACE_FLUSH();
+            return code;
         } else {
             fmt::print(stderr, "Unknown action: {}\n", action);
             fmt::print(stderr, "Available actions: {}\n", action_names_string);
@@ -0,0 +1,252 @@
+#include "adaptive_lns.h"
+#include "model_arrays.h"
+#include "model_cache.h"
+#include "utils.h"
+#include "trace.h"
+#include "fmt/core.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+using namespace std;
+
+const char* operatorName(LNSOperator op) {
+    switch (op) {
+        case LNSOperator::Random: return "random";
+        case LNSOperator::Constraint: return "constraint";
+        case LNSOperator::RINS: return "rins";
+        case LNSOperator::LocalBranching: return "local_branching";
+        case LNSOperator::ObjectiveGuided: return "objective";
+    }
+    return "unknown";
+}
+
+OperatorBandit::OperatorBandit(double exploration, double step_size)
+    : exploration(exploration), step_size(step_size) {}
+
+LNSOperator OperatorBandit::select(mt19937& rng) {
+    // Every operator is tried once, in random order, before UCB takes over
+    vector<int> untried;
+    for (int i = 0; i < NUM_LNS_OPERATORS; i++) {
+        if (enabled[i] && counts[i] == 0) {
+            untried.push_back(i);
+        }
+    }
+    if (!untried.empty()) {
+        return (LNSOperator)untried[boundedRand(rng, untried.size())];
+    }
+
+    int best = 0;
+    double best_score = -1e100;
+    for (int i = 0; i < NUM_LNS_OPERATORS; i++) {
+        if (!enabled[i]) {
+            continue;
+        }
+        double score = values[i] + exploration * sqrt(log((double)total) / counts[i]);
+        if (score > best_score) {
+            best_score = score;
+            best = i;
+        }
+    }
+    return (LNSOperator)best;
+}
+
+void OperatorBandit::update(LNSOperator op, double reward) {
+    int i = (int)op;
+    counts[i]++;
+    total++;
+    // The first reward replaces the zero prior instead of being averaged with it
+    double step = counts[i] == 1 ? 1.0 : step_size;
+    values[i] += step * (reward - values[i]);
+}
+
+void OperatorBandit::disable(LNSOperator op) {
+    enabled[(int)op] = false;
+}
+
+NeighborhoodSizeController::NeighborhoodSizeController(double free_fraction, double min_fraction, double max_fraction)
+    : free_fraction(clamp(free_fraction, min_fraction, max_fraction)), min_fraction(min_fraction), max_fraction(max_fraction) {}
+
+void NeighborhoodSizeController::update(int status, bool improved) {
+    if (improved) {
+        return;
+    }
+    if (status == GRB_OPTIMAL || status == GRB_INFEASIBLE) {
+        free_fraction *= 1.25;
+    } else if (status == GRB_TIME_LIMIT || status == GRB_WORK_LIMIT) {
+        free_fraction *= 0.8;
+    }
+    free_fraction = clamp(free_fraction, min_fraction, max_fraction);
+}
+
+AdaptiveLNS::AdaptiveLNS(GRBModel& model, vector<GRBVar>& binary_variables, const string& instance_name, double initial_free_fraction)
+    : model(model),
+      binary_variables(binary_variables),
+      instance_name(instance_name),
+      num_binary_variables(binary_variables.size()),
+      controller(initial_free_fraction) {
+    for (int i = 0; i < NUM_LNS_OPERATORS; i++) {
+        LNSOperatorStats op_stats = {
+            .operator_name = operatorName((LNSOperator)i),
+        };
+        stats.push_back(op_stats);
+    }
+    // The objective operator needs an objective to guide it
+    objective = getAttrArray(model, GRB_DoubleAttr_Obj, binary_variables.data(), num_binary_variables);
+    if (all_of(objective.begin(), objective.end(), [](double c) { return c == 0.0; })) {
+        bandit.disable(LNSOperator::ObjectiveGuided);
+    }
+}
+
+Neighborhood AdaptiveLNS::next(const vector<double>& binary_values, mt19937& rng) {
+    Neighborhood neighborhood;
+    neighborhood.op = bandit.select(rng);
+    int num_free = max(1, (int)round(controller.freeFraction() * num_binary_variables));
+
+    if (neighborhood.op == LNSOperator::RINS && !lp_solved) {
+        solveLP();
+        if (lp_values.empty()) {
+            bandit.disable(LNSOperator::RINS);
+            neighborhood.op = bandit.select(rng);
+        }
+    }
+
+    switch (neighborhood.op) {
+        case LNSOperator::Random:
+            neighborhood.fixing_indices = fixRandom(num_free, rng);
+            break;
+        case LNSOperator::Constraint:
+            if (!generator) {
+                generator.emplace(ModelCache::getInstance().getVarConstraintIndex(instance_name, model, binary_variables));
+            }
+            neighborhood.fixing_indices = generator->blocks(num_free, rng);
+            break;
+        case LNSOperator::RINS:
+            neighborhood.fixing_indices = fixRINS(binary_values, num_free, rng);
+            break;
+        case LNSOperator::LocalBranching:
+            // A ball of k flips is much larger than k free variables
+            neighborhood.local_branching_k = max(1, num_free / 10);
+            break;
+        case LNSOperator::ObjectiveGuided:
+            neighborhood.fixing_indices = fixObjectiveGuided(binary_values, num_free, rng);
+            break;
+    }
+    return neighborhood;
+}
+
+void AdaptiveLNS::update(const Neighborhood& neighborhood, int status, bool improved, double gain, double time_s) {
+    LNSOperatorStats& op_stats = stats[(int)neighborhood.op];
+    op_stats.selections++;
+    op_stats.improvements += improved;
+    op_stats.total_gain += gain;
+    op_stats.total_time_s += time_s;
+
+    bandit.update(neighborhood.op, improved ? 1.0 : 0.0);
+    controller.update(status, improved);
+}
+
+vector<LNSOperatorStats> AdaptiveLNS::getStats() const {
+    vector<LNSOperatorStats> result = stats;
+    for (int i = 0; i < NUM_LNS_OPERATORS; i++) {
+        result[i].value = bandit.value((LNSOperator)i);
+    }
+    return result;
+}
+
+vector<int> AdaptiveLNS::fixRandom(int num_free, mt19937& rng) {
+    return sampler.sample(num_binary_variables, max(0, num_binary_variables - num_free), rng);
+}
+
+vector<int> AdaptiveLNS::fixOutside(const vector<char>& is_free) {
+    vector<int> fixing_indices;
+    for (int i = 0; i < num_binary_variables; i++) {
+        if (!is_free[i]) {
+            fixing_indices.push_back(i);
+        }
+    }
+    return fixing_indices;
+}
+
+void AdaptiveLNS::solveLP() {
+    TRACE_SPAN("lns_lp_relaxation");
+    lp_solved = true;
+    // Inherits the limit of the upcoming sub-MIP
+    GRBModel relaxed = model.relax();
+    relaxed.optimize();
+    lp_work += relaxed.get(GRB_DoubleAttr_Work);
+    if (relaxed.get(GRB_IntAttr_Status) != GRB_OPTIMAL) {
+        fmt::print("LP relaxation not solved, disabling RINS\n");
+        return;
+    }
+    unique_ptr<GRBVar[]> relaxed_vars(relaxed.getVars());
+    vector<GRBVar> relaxed_binaries;
+    relaxed_binaries.reserve(num_binary_variables);
+    for (GRBVar& var : binary_variables) {
+        relaxed_binaries.push_back(relaxed_vars[var.index()]);
+    }
+    lp_values = getAttrArray(relaxed, GRB_DoubleAttr_X, relaxed_binaries.data(), num_binary_variables);
+}
+
+// RINS: variables where the incumbent and the LP relaxation agree stay fixed.
+// The disagreement set is trimmed or padded to the target size.
+vector<int> AdaptiveLNS::fixRINS(const vector<double>& binary_values, int num_free, mt19937& rng) {
+    vector<int> disagree;
+    vector<int> agree;
+    for (int i = 0; i < num_binary_variables; i++) {
+        if (abs(lp_values[i] - binary_values[i]) > 1e-6) {
+            disagree.push_back(i);
+        } else {
+            agree.push_back(i);
+        }
+    }
+    sampler.shuffle(disagree, rng);
+    sampler.shuffle(agree, rng);
+
+    vector<char> is_free(num_binary_variables, 0);
+    for (int k = 0; k < num_free && k < disagree.size(); k++) {
+        is_free[disagree[k]] = 1;
+    }
+    for (int k = 0; k < num_free - (int)disagree.size() && k < agree.size(); k++) {
+        is_free[agree[k]] = 1;
+    }
+    return fixOutside(is_free);
+}
+
+// Frees variables whose flip improves the objective, sampled with probability
+// proportional to the improvement
+vector<int> AdaptiveLNS::fixObjectiveGuided(const vector<double>& binary_values, int num_free, mt19937& rng) {
+    double direction = model.get(GRB_IntAttr_ModelSense) == GRB_MAXIMIZE ? 1.0 : -1.0;
+    double mean_abs = 0.0;
+    for (double c : objective) {
+        mean_abs += abs(c);
+    }
+    mean_abs = max(mean_abs / max(1, num_binary_variables), 1e-9);
+
+    vector<double> weights(num_binary_variables);
+    for (int i = 0; i < num_binary_variables; i++) {
+        double gain = direction * objective[i] * (1.0 - 2.0 * binary_values[i]);
+        // Variables that cannot improve the objective keep a small weight
+        weights[i] = max(gain, 0.0) + 0.01 * mean_abs;
+    }
+
+    vector<char> is_free(num_binary_variables, 0);
+    for (int i : sampler.sampleWeighted(AliasTable(weights), num_free, rng)) {
+        is_free[i] = 1;
+    }
+    return fixOutside(is_free);
+}
+
+GRBConstr addLocalBranchingConstraint(GRBModel& model, vector<GRBVar>& binary_variables, const vector<double>& binary_values, int k) {
+    int num_binary_variables = binary_variables.size();
+    vector<double> coeffs(num_binary_variables);
+    double ones = 0.0;
+    for (int i = 0; i < num_binary_variables; i++) {
+        // Distance term is x for incumbent 0 and (1 - x) for incumbent 1
+        coeffs[i] = binary_values[i] > 0.5 ? -1.0 : 1.0;
+        ones += binary_values[i] > 0.5;
+    }
+    GRBLinExpr distance = ones;
+    distance.addTerms(coeffs.data(), binary_variables.data(), num_binary_variables);
+    return model.addConstr(distance <= k, "LocalBranching");
+}
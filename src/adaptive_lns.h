@@ -0,0 +1,108 @@
+#pragma once
+
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "db.h"
+#include "neighborhood.h"
+#include "sampler.h"
+#include "gurobi_c++.h"
+
+using namespace std;
+
+enum class LNSOperator { Random, Constraint, RINS, LocalBranching, ObjectiveGuided };
+
+constexpr int NUM_LNS_OPERATORS = 5;
+
+const char* operatorName(LNSOperator op);
+
+// Destroy step of one LNS iteration
+struct Neighborhood {
+    LNSOperator op = LNSOperator::Random;
+    vector<int> fixing_indices; // binary indices fixed to the incumbent
+    int local_branching_k = -1; // >= 0 adds a local branching row instead of fixing
+};
+
+// UCB1 over the operators with exponential recency weighting, since the operator
+// that pays off early in a search is often not the one that pays off late
+class OperatorBandit {
+    public:
+        explicit OperatorBandit(double exploration = 0.5, double step_size = 0.2);
+
+        LNSOperator select(mt19937& rng);
+        void update(LNSOperator op, double reward);
+        void disable(LNSOperator op);
+
+        double value(LNSOperator op) const { return values[(int)op]; }
+        int selections(LNSOperator op) const { return counts[(int)op]; }
+
+    private:
+        double exploration;
+        double step_size;
+        int total = 0;
+        double values[NUM_LNS_OPERATORS] = {};
+        int counts[NUM_LNS_OPERATORS] = {};
+        bool enabled[NUM_LNS_OPERATORS] = {true, true, true, true, true};
+};
+
+// Adapts the fraction of free binary variables to the outcome of each sub-MIP.
+// Neighborhoods solved to optimality without improvement are too small, sub-MIPs
+// that hit the time or work limit without improvement are too large.
+class NeighborhoodSizeController {
+    public:
+        NeighborhoodSizeController(double free_fraction, double min_fraction = 0.02, double max_fraction = 0.9);
+
+        double freeFraction() const { return free_fraction; }
+        void update(int status, bool improved);
+
+    private:
+        double free_fraction;
+        double min_fraction;
+        double max_fraction;
+};
+
+// Adaptive LNS: a bandit picks the destroy operator and a controller the neighborhood size.
+// Model data the operators need (rows, LP relaxation) is computed the first time it is used.
+class AdaptiveLNS {
+    public:
+        // The LP relaxation used by RINS gets the time or work limit set on the model
+        AdaptiveLNS(GRBModel& model, vector<GRBVar>& binary_variables, const string& instance_name, double initial_free_fraction);
+
+        Neighborhood next(const vector<double>& binary_values, mt19937& rng);
+        // gain is the objective improvement of the iteration, 0 if none
+        void update(const Neighborhood& neighborhood, int status, bool improved, double gain, double time_s);
+        vector<LNSOperatorStats> getStats() const;
+
+        double freeFraction() const { return controller.freeFraction(); }
+        // Work of the LP relaxation solved since the last call, part of the iteration's effort
+        double takeLPWork() { return exchange(lp_work, 0.0); }
+
+    private:
+        GRBModel& model;
+        vector<GRBVar>& binary_variables;
+        string instance_name;
+        int num_binary_variables;
+        OperatorBandit bandit;
+        NeighborhoodSizeController controller;
+        Sampler sampler;
+        vector<LNSOperatorStats> stats;
+
+        // Constraint blocks over the instance index, built on the first Constraint selection
+        optional<NeighborhoodGenerator> generator;
+        // LP relaxation values of the binary variables, empty if the LP failed
+        vector<double> lp_values;
+        bool lp_solved = false;
+        double lp_work = 0.0;
+        vector<double> objective;
+
+        vector<int> fixRandom(int num_free, mt19937& rng);
+        vector<int> fixOutside(const vector<char>& is_free);
+        vector<int> fixRINS(const vector<double>& binary_values, int num_free, mt19937& rng);
+        vector<int> fixObjectiveGuided(const vector<double>& binary_values, int num_free, mt19937& rng);
+        void solveLP();
+};
+
+// Local branching row: at most k binary variables differ from binary_values
+GRBConstr addLocalBranchingConstraint(GRBModel& model, vector<GRBVar>& binary_variables, const vector<double>& binary_values, int k);
@@ -0,0 +1,60 @@
+#include "bound_fixer.h"
+#include <memory>
+
+using namespace std;
+
+BoundFixer::BoundFixer(GRBModel& model, vector<GRBVar>& variables) : model(model), variables(variables) {
+    // Gurobi applies changes lazily, bounds read after a restore() would still be the
+    // fixed ones, so the original bounds are read once while the model is unfixed
+    model.update();
+    int count = variables.size();
+    unique_ptr<double[]> lb(model.get(GRB_DoubleAttr_LB, variables.data(), count));
+    unique_ptr<double[]> ub(model.get(GRB_DoubleAttr_UB, variables.data(), count));
+    original_lb.assign(lb.get(), lb.get() + count);
+    original_ub.assign(ub.get(), ub.get() + count);
+}
+
+BoundFixer::~BoundFixer() {
+    try {
+        restore();
+    } catch (GRBException e) {
+        // The model is being torn down as well
+    }
+}
+
+void BoundFixer::fix(const vector<int>& indices, const vector<double>& values) {
+    restore();
+    int count = indices.size();
+    if (count == 0) {
+        return;
+    }
+
+    fixed_indices = indices;
+    fixed_vars.clear();
+    fixed_values.clear();
+    fixed_vars.reserve(count);
+    fixed_values.reserve(count);
+    for (int var_index : indices) {
+        fixed_vars.push_back(variables[var_index]);
+        fixed_values.push_back(values[var_index]);
+    }
+    model.set(GRB_DoubleAttr_LB, fixed_vars.data(), fixed_values.data(), count);
+    model.set(GRB_DoubleAttr_UB, fixed_vars.data(), fixed_values.data(), count);
+}
+
+void BoundFixer::restore() {
+    int count = fixed_vars.size();
+    if (count == 0) {
+        return;
+    }
+    // fixed_values is free again, gather the original bounds into it
+    for (int i = 0; i < count; i++) {
+        fixed_values[i] = original_lb[fixed_indices[i]];
+    }
+    model.set(GRB_DoubleAttr_LB, fixed_vars.data(), fixed_values.data(), count);
+    for (int i = 0; i < count; i++) {
+        fixed_values[i] = original_ub[fixed_indices[i]];
+    }
+    model.set(GRB_DoubleAttr_UB, fixed_vars.data(), fixed_values.data(), count);
+    fixed_vars.clear();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include "gurobi_c++.h"
+
+using namespace std;
+
+// Fixes variables through their bounds with one bulk attribute call per bound.
+// The original bounds of all variables are read once on construction, so the
+// neighborhood can be released with restore() and the model reused for the next one. Unlike a fixing row this
+// adds no nonzeros and presolve sees the fixings directly.
+class BoundFixer {
+    public:
+        BoundFixer(GRBModel& model, vector<GRBVar>& variables);
+        ~BoundFixer();
+
+        // Fixes variables[i] to values[i] for every i in indices
+        void fix(const vector<int>& indices, const vector<double>& values);
+        void restore();
+        // Keeps the current fixings in the model and forgets the original bounds
+        void release() { fixed_vars.clear(); }
+        int numFixed() const { return fixed_vars.size(); }
+
+    private:
+        GRBModel& model;
+        vector<GRBVar>& variables;
+        vector<int> fixed_indices;
+        vector<GRBVar> fixed_vars;
+        vector<double> fixed_values;
+        vector<double> original_lb; // of every variable, in variables order
+        vector<double> original_ub;
+};
@@ -0,0 +1,169 @@
+#include "callback_state.h"
+#include "fmt/core.h"
+#include <memory>
+
+using namespace std;
+
+CallbackState::CallbackState(GRBVar* binary_vars, int num_binary_vars, string instance_name, 
+  MetricsCollector* collector, int every_nodes, int every_ms) {
+    this->instance_name = instance_name;
+    this->binary_vars = binary_vars;
+    this->num_binary_vars = num_binary_vars;
+    this->collector = collector;
+    this->every_nodes = max(1, every_nodes);
+    this->every_ms = max(0, every_ms);
+    start_time = chrono::steady_clock::now();
+}
+
+void CallbackState::printSummary() {
+  fmt::print("Summary:\n");
+  fmt::print("Number of node metrics sampled using callback: {}\n", sampled_count);
+  if (exchange) {
+    fmt::print("Helper solutions injected: {}\n", injected_count);
+  }
+  if (collector) {
+    fmt::print("Written: {}, dropped: {}\n", collector->getWritten(), collector->getDropped());
+  }
+}
+
+// Returns the number of strictly positive values, written branch free so it vectorizes
+static int countPositive(const double* x, int n) {
+  int count = 0;
+  for (int i = 0; i < n; i++) {
+    count += x[i] > 0.0;
+  }
+  return count;
+}
+
+void CallbackState::handleMipNode() {
+  // The node relaxation is only available for nodes solved to optimality
+  if (getIntInfo(GRB_CB_MIPNODE_STATUS) != GRB_OPTIMAL) {
+    return;
+  }
+  double node = getDoubleInfo(GRB_CB_MIPNODE_NODCNT);
+  if (node - last_sampled_node < every_nodes) {
+    return;
+  }
+  auto now = chrono::steady_clock::now();
+  int64_t elapsed_ms = chrono::duration_cast<chrono::milliseconds>(now - start_time).count();
+  if (last_sampled_ms >= 0 && elapsed_ms - last_sampled_ms < every_ms) {
+    return;
+  }
+  last_sampled_node = node;
+  last_sampled_ms = elapsed_ms;
+
+  int solcnt = getIntInfo(GRB_CB_MIPNODE_SOLCNT);
+  int phase = getIntInfo(GRB_CB_MIPNODE_PHASE);
+  // The C++ API always allocates the relaxation vector, sampling bounds how often
+  unique_ptr<double[]> x(getNodeRel(binary_vars, num_binary_vars));
+  sampled_count++;
+  if (collector) {
+    collector->push({
+      .non_zero_count = countPositive(x.get(), num_binary_vars), 
+      .phase = phase, 
+      .solcnt = solcnt, 
+      .elapsed_ms = elapsed_ms,
+    });
+  }
+}
+
+void CallbackState::setRace(RaceState* race, int job_id, bool restricted) {
+  this->race = race;
+  this->job_id = job_id;
+  race_restricted = restricted;
+}
+
+void CallbackState::setExchange(SolutionExchange* exchange, GRBVar* vars, int num_vars) {
+  this->exchange = exchange;
+  this->vars = vars;
+  this->num_vars = num_vars;
+}
+
+void CallbackState::handleExchange() {
+  if (where == GRB_CB_MIPSOL) {
+    unique_ptr<double[]> x(getSolution(vars, num_vars));
+    exchange->publish(getDoubleInfo(GRB_CB_MIPSOL_OBJ), vector<double>(x.get(), x.get() + num_vars), -1);
+    return;
+  }
+  // setSolution is only allowed at MIPNODE, the version check keeps the common path to one atomic load
+  if (where != GRB_CB_MIPNODE || exchange->version() == seen_version) {
+    return;
+  }
+  seen_version = exchange->version();
+  auto solution = exchange->latest();
+  if (solution->source >= 0 && exchange->isBetter(solution->obj_val, getDoubleInfo(GRB_CB_MIPNODE_OBJBST))) {
+    setSolution(vars, solution->values.data(), num_vars);
+    injected_count++;
+  }
+}
+
+void CallbackState::enableTimeline(int sense) {
+  this->sense = sense;
+  record_timeline = true;
+}
+
+void CallbackState::handleTimeline() {
+  double obj_val = getDoubleInfo(GRB_CB_MIPSOL_OBJ);
+  if (!timeline.empty()) {
+    double best = timeline.back().obj_val;
+    if (sense == GRB_MAXIMIZE ? obj_val <= best : obj_val >= best) {
+      return;
+    }
+  }
+  timeline.push_back({
+    .time_s = getDoubleInfo(GRB_CB_RUNTIME),
+    .obj_val = obj_val,
+    .bound = getDoubleInfo(GRB_CB_MIPSOL_OBJBND),
+    .node_count = getDoubleInfo(GRB_CB_MIPSOL_NODCNT),
+  });
+}
+
+void CallbackState::setTermination(TerminationPolicy* termination) {
+  this->termination = termination;
+}
+
+void CallbackState::handleTermination() {
+  const char* reason = termination->check(
+    getDoubleInfo(GRB_CB_RUNTIME),
+    getDoubleInfo(GRB_CB_MIP_NODCNT),
+    getDoubleInfo(GRB_CB_MIP_OBJBST),
+    getDoubleInfo(GRB_CB_MIP_OBJBND)
+  );
+  if (reason && !termination_reason) {
+    termination_reason = reason;
+    abort();
+  }
+}
+
+void CallbackState::handleRace() {
+  if (where == GRB_CB_MIPSOL) {
+    race->offer(getDoubleInfo(GRB_CB_MIPSOL_OBJ), job_id);
+  } else if (where == GRB_CB_MIP && !race_restricted) {
+    race->checkBound(getDoubleInfo(GRB_CB_MIP_OBJBND));
+  }
+  if (race->isFinished()) {
+    abort();
+  }
+}
+
+void CallbackState::callback() {
+  try {
+    if (race) {
+      handleRace();
+    }
+    if (termination && where == GRB_CB_MIP) {
+      handleTermination();
+    }
+    if (record_timeline && where == GRB_CB_MIPSOL) {
+      handleTimeline();
+    }
+    if (exchange) {
+      handleExchange();
+    }
+    if (where == GRB_CB_MIPNODE && collector) {
+      handleMipNode();
+    }
+  } catch (GRBException e) {
+    error_count++;
+  }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include "gurobi_c++.h"
+#include "metrics_collector.h"
+#include "race.h"
+#include "solution_exchange.h"
+#include "incumbent_timeline.h"
+#include "termination.h"
+#include <vector>
+
+using namespace std;
+
+// Samples node relaxation metrics at MIPNODE every every_nodes explored nodes 
+// and at least every_ms milliseconds apart, and pushes them to the collector.
+class CallbackState: public GRBCallback
+{
+  public:
+    CallbackState(GRBVar* binary_vars, int num_binary_vars, string instance_name, 
+      MetricsCollector* collector, int every_nodes = 1, int every_ms = 0);
+
+    void printSummary();
+    // Reports incumbents, and bounds unless the model is restricted, to the race and
+    // aborts once it is finished
+    void setRace(RaceState* race, int job_id, bool restricted);
+    // Publishes new incumbents at MIPSOL and injects better helper solutions at MIPNODE
+    void setExchange(SolutionExchange* exchange, GRBVar* vars, int num_vars);
+    // Records every improving MIPSOL incumbent with its time, bound and node count
+    void enableTimeline(int sense);
+    const vector<IncumbentEvent>& getTimeline() const { return timeline; }
+    // Aborts the solve when a termination policy fires
+    void setTermination(TerminationPolicy* termination);
+    // Policy that aborted the solve, nullptr if none did
+    const char* getTerminationReason() const { return termination_reason; }
+
+  private:
+    GRBVar* binary_vars;
+    int num_binary_vars;
+    MetricsCollector* collector;
+    int every_nodes;
+    int every_ms;
+    double last_sampled_node = -1e100;
+    int64_t last_sampled_ms = -1;
+    int64_t sampled_count = 0;
+    chrono::steady_clock::time_point start_time;
+    int error_count = 0;
+    string instance_name;
+    RaceState* race = nullptr;
+    int job_id = -1;
+    bool race_restricted = false;
+    SolutionExchange* exchange = nullptr;
+    GRBVar* vars = nullptr;
+    int num_vars = 0;
+    uint64_t seen_version = 0;
+    int64_t injected_count = 0;
+    bool record_timeline = false;
+    int sense = 1;
+    vector<IncumbentEvent> timeline;
+    TerminationPolicy* termination = nullptr;
+    const char* termination_reason = nullptr;
+    
+    void handleMipNode();
+    void handleRace();
+    void handleExchange();
+    void handleTimeline();
+    void handleTermination();
+
+  protected:
+    void callback();
+};
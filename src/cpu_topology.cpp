@@ -0,0 +1,178 @@
+#include "cpu_topology.h"
+#include "fmt/core.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <pthread.h>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+
+using namespace std;
+
+const string SYSFS_CPU = "/sys/devices/system/cpu";
+const string SYSFS_NODE = "/sys/devices/system/node";
+
+static int readInt(const string& path, int fallback) {
+    ifstream file(path);
+    int value;
+    return file >> value ? value : fallback;
+}
+
+vector<int> parseCpuList(const string& list) {
+    vector<int> cpus;
+    size_t start = 0;
+    while (start < list.size()) {
+        size_t end = list.find(',', start);
+        if (end == string::npos) {
+            end = list.size();
+        }
+        string range = list.substr(start, end - start);
+        size_t dash = range.find('-');
+        try {
+            if (dash == string::npos) {
+                cpus.push_back(stoi(range));
+            } else {
+                for (int cpu = stoi(range.substr(0, dash)); cpu <= stoi(range.substr(dash + 1)); cpu++) {
+                    cpus.push_back(cpu);
+                }
+            }
+        } catch (exception&) {
+            // Blank or malformed range, e.g. the trailing newline of a sysfs file
+        }
+        start = end + 1;
+    }
+    return cpus;
+}
+
+string formatCpuList(const vector<int>& cpus) {
+    vector<int> sorted = cpus;
+    sort(sorted.begin(), sorted.end());
+    string list;
+    for (size_t i = 0; i < sorted.size();) {
+        size_t j = i;
+        while (j + 1 < sorted.size() && sorted[j + 1] == sorted[j] + 1) {
+            j++;
+        }
+        if (!list.empty()) {
+            list += ",";
+        }
+        list += j == i ? to_string(sorted[i]) : fmt::format("{}-{}", sorted[i], sorted[j]);
+        i = j + 1;
+    }
+    return list;
+}
+
+// NUMA node of every CPU, empty without NUMA support in sysfs
+static unordered_map<int, int> cpuNodes() {
+    unordered_map<int, int> nodes;
+    error_code error;
+    for (auto& entry : filesystem::directory_iterator(SYSFS_NODE, error)) {
+        string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4 || !isdigit(name[4])) {
+            continue;
+        }
+        ifstream file(entry.path() / "cpulist");
+        string list;
+        getline(file, list);
+        for (int cpu : parseCpuList(list)) {
+            nodes[cpu] = stoi(name.substr(4));
+        }
+    }
+    return nodes;
+}
+
+CpuTopology detectTopology() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    unordered_map<int, int> nodes = cpuNodes();
+
+    // Logical CPUs sharing a package and core id are SMT siblings
+    map<tuple<int, int, int>, CpuCore> cores;
+    CpuTopology topology;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        string topology_dir = fmt::format("{}/cpu{}/topology/", SYSFS_CPU, cpu);
+        int package = readInt(topology_dir + "physical_package_id", 0);
+        // Without topology information every logical CPU is its own core
+        int core_id = readInt(topology_dir + "core_id", cpu);
+        auto node = nodes.find(cpu);
+        int numa_node = node != nodes.end() ? node->second : 0;
+        CpuCore& core = cores[{numa_node, package, core_id}];
+        core.package = package;
+        core.core_id = core_id;
+        core.numa_node = numa_node;
+        core.cpus.push_back(cpu);
+        topology.num_cpus++;
+    }
+
+    set<int> used_nodes;
+    for (auto& [key, core] : cores) {
+        used_nodes.insert(core.numa_node);
+        topology.cores.push_back(core);
+    }
+    topology.num_nodes = max(1, (int)used_nodes.size());
+    return topology;
+}
+
+static CpuPlacement makePlacement(const vector<const CpuCore*>& cores) {
+    CpuPlacement placement;
+    placement.num_cores = cores.size();
+    placement.numa_node = cores.empty() ? -1 : cores[0]->numa_node;
+    for (const CpuCore* core : cores) {
+        placement.cpus.insert(placement.cpus.end(), core->cpus.begin(), core->cpus.end());
+        if (core->numa_node != placement.numa_node) {
+            placement.numa_node = -1;
+        }
+    }
+    return placement;
+}
+
+vector<CpuPlacement> placeWorkers(const CpuTopology& topology, int workers, int cores_per_worker) {
+    map<int, vector<const CpuCore*>> node_cores;
+    for (const CpuCore& core : topology.cores) {
+        node_cores[core.numa_node].push_back(&core);
+    }
+
+    // Whole workers inside each node first, then the cores left over on every node
+    vector<CpuPlacement> placements;
+    vector<const CpuCore*> leftover;
+    for (auto& [node, cores] : node_cores) {
+        size_t next = 0;
+        while (next + cores_per_worker <= cores.size() && (int)placements.size() < workers) {
+            placements.push_back(makePlacement(vector<const CpuCore*>(cores.begin() + next, cores.begin() + next + cores_per_worker)));
+            next += cores_per_worker;
+        }
+        leftover.insert(leftover.end(), cores.begin() + next, cores.end());
+    }
+    for (size_t next = 0; next + cores_per_worker <= leftover.size() && (int)placements.size() < workers; next += cores_per_worker) {
+        placements.push_back(makePlacement(vector<const CpuCore*>(leftover.begin() + next, leftover.begin() + next + cores_per_worker)));
+    }
+    return placements;
+}
+
+ThreadPinning::ThreadPinning(const vector<int>& cpus) {
+    CPU_ZERO(&previous);
+    if (cpus.empty() || pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous) != 0) {
+        return;
+    }
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &mask);
+    }
+    is_pinned = pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+    if (!is_pinned) {
+        fmt::print("Could not pin thread to CPUs {}\n", formatCpuList(cpus));
+    }
+}
+
+ThreadPinning::~ThreadPinning() {
+    if (is_pinned) {
+        pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <sched.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// A physical core and its SMT siblings
+struct CpuCore {
+    int package = 0;
+    int core_id = 0;
+    int numa_node = 0;
+    vector<int> cpus; // logical CPUs
+};
+
+// Cores this process may run on, read from sysfs and restricted to the affinity mask
+// the process was started with (taskset, cgroups). Cores are ordered by NUMA node.
+struct CpuTopology {
+    vector<CpuCore> cores;
+    int num_cpus = 0;
+    int num_nodes = 1;
+};
+
+CpuTopology detectTopology();
+
+// Core set of one worker
+struct CpuPlacement {
+    vector<int> cpus; // logical CPUs of the cores, SMT siblings included
+    int num_cores = 0; // Gurobi Threads of the worker's jobs
+    int numa_node = -1; // -1 when the cores span several nodes
+};
+
+// Disjoint sets of cores_per_worker cores, kept inside a NUMA node when they fit.
+// Returns fewer placements than workers when the machine has too few cores.
+vector<CpuPlacement> placeWorkers(const CpuTopology& topology, int workers, int cores_per_worker);
+
+// "0-3,8" style lists, as in sysfs and taskset
+vector<int> parseCpuList(const string& list);
+string formatCpuList(const vector<int>& cpus);
+
+// Pins the calling thread to cpus until the end of the scope. Threads it creates
+// meanwhile, such as the Gurobi threads of its solves, inherit the mask.
+class ThreadPinning {
+    public:
+        explicit ThreadPinning(const vector<int>& cpus);
+        ~ThreadPinning();
+        ThreadPinning(const ThreadPinning&) = delete;
+        ThreadPinning& operator=(const ThreadPinning&) = delete;
+
+        bool pinned() const { return is_pinned; }
+
+    private:
+        cpu_set_t previous;
+        bool is_pinned = false;
+};
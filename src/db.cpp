@@ -6,6 +6,16 @@
 #include <sstream>
 #include "load_model.h"
 #include "binary_variables.h"
+#include "solution_codec.h"
+#include "mps_reader.h"
+#include "thread_pool.h"
+#include "executor.h"
+#include "job_queue.h"
+#include "trace.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
 
 using namespace std;
 using namespace sqlite_orm;
@@ -22,60 +32,209 @@ vector<string> get_instance_names() {
 }
 
 void sync_db() {
-    auto storage = get_storage();
+    auto& storage = get_storage();
     fmt::print("Syncing db schema\n");
     storage.sync_schema(true);
+    storage.update_all(
+        sqlite_orm::set(c(&Job::limit_value) = &Job::time_limit_s),
+        where(c(&Job::limit_value) < 0)
+    );
+    backfillParamsKeys();
 }
 
 vector<Instance> get_instances() {
-    auto storage = get_storage();
+    lock_guard<mutex> lock(get_db_mutex());
+    auto& storage = get_storage();
     return storage.get_all<Instance>();
 }
 
 vector<Instance> get_selected_instances() {
-    auto storage = get_storage();
+    lock_guard<mutex> lock(get_db_mutex());
+    auto& storage = get_storage();
     return storage.get_all<Instance>(where(c(&Instance::selected) == true));
 }
 
 void seed_instances() {
     vector<string> instance_names = get_instance_names();
-    auto storage = get_storage();
-    for (string name : instance_names) {
-        GRBModel model = loadModel(name);
-        vector<GRBVar> binary_variables = getBinaryVariables(model);
-        int num_bin_variables = binary_variables.size();
-        if (num_bin_variables == 0) {
-            fmt::print("Instance {} has no binary variables, skipping\n", name);
-            continue;
+    unordered_map<string, InstanceFile> seeded_files;
+    {
+        lock_guard<mutex> lock(get_db_mutex());
+        for (InstanceFile& file : get_storage().get_all<InstanceFile>()) {
+            seeded_files[file.path] = file;
         }
-        Instance instance = {
-            .id = name, 
-            .name = name, 
-            .num_bin_variables = num_bin_variables, 
-            .num_int_variables = model.get(GRB_IntAttr_NumVars)
-        };
-        storage.replace(instance);
     }
+
+    int instance_count = instance_names.size();
+    atomic<int> done_count{0};
+    atomic<int> parsed_count{0};
+    auto start = chrono::steady_clock::now();
+    parallel_for(instance_count, max(1, getExecutorConfig().workers), [&](int i, int worker_id) {
+        TRACE_SPAN("seed_instance");
+        string name = instance_names[i];
+        string path = getMpsPath(name);
+        try {
+            InstanceFile file = {
+                .path = path,
+                .instance_name = name,
+                .size = (int64_t)filesystem::file_size(path),
+                .mtime = (int64_t)filesystem::last_write_time(path).time_since_epoch().count(),
+            };
+
+            // Same size and mtime is trusted, otherwise the content decides
+            auto seeded = seeded_files.find(path);
+            bool unchanged = false;
+            if (seeded != seeded_files.end() && seeded->second.size == file.size) {
+                if (seeded->second.mtime == file.mtime) {
+                    unchanged = true;
+                } else {
+                    TRACE_SPAN("hash_file");
+                    file.content_hash = fmt::format("{:016x}", hashFile(path));
+                    unchanged = file.content_hash == seeded->second.content_hash;
+                }
+            }
+            if (unchanged) {
+                if (seeded->second.mtime != file.mtime) {
+                    // Same content under a new mtime, record it so the next seed takes the fast path
+                    InstanceFile touched = seeded->second;
+                    touched.mtime = file.mtime;
+                    touched.content_hash = file.content_hash;
+                    lock_guard<mutex> lock(get_db_mutex());
+                    get_storage().replace(touched);
+                }
+                fmt::print("[{}/{}] {} unchanged\n", ++done_count, instance_count, name);
+                return;
+            }
+
+            auto load_start = chrono::steady_clock::now();
+            MpsCounts counts;
+            {
+                TRACE_SPAN("count_mps");
+                counts = countMps(path);
+            }
+            file.load_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - load_start).count();
+            if (file.content_hash.empty()) {
+                TRACE_SPAN("hash_file");
+                file.content_hash = fmt::format("{:016x}", hashFile(path));
+            }
+            file.num_bin_variables = counts.num_bin_vars;
+            file.num_vars = counts.num_vars;
+            parsed_count++;
+
+            TRACE_SPAN("seed_write");
+            lock_guard<mutex> lock(get_db_mutex());
+            auto& storage = get_storage();
+            storage.transaction([&] {
+                if (counts.num_bin_vars > 0) {
+                    Instance instance = {
+                        .id = name, 
+                        .name = name, 
+                        .num_bin_variables = counts.num_bin_vars, 
+                        .num_int_variables = counts.num_vars
+                    };
+                    storage.replace(instance);
+                } else {
+                    // The file may have had binaries when it was seeded before
+                    storage.remove_all<Instance>(where(c(&Instance::id) == name));
+                }
+                storage.replace(file);
+                return true;
+            });
+            if (counts.num_bin_vars == 0) {
+                fmt::print("[{}/{}] {} has no binary variables, skipping ({:.0f} ms)\n", ++done_count, instance_count, name, file.load_ms);
+            } else {
+                fmt::print("[{}/{}] {} loaded in {:.0f} ms\n", ++done_count, instance_count, name, file.load_ms);
+            }
+        } catch (exception& e) {
+            fmt::print("[{}/{}] Error reading instance {}: {}\n", ++done_count, instance_count, name, e.what());
+        }
+    });
+
+    double elapsed_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
     vector<Instance> instances = get_instances();
-    fmt::print("Seeded {} instances\n", instances.size());
+    fmt::print("Seeded {} instances ({} files parsed) in {:.1f}s\n", instances.size(), parsed_count.load(), elapsed_s);
 }
 
-void batch_insert_metrics(vector<CallbackMetric>& metrics, int batch_size) {
-    auto storage = get_storage();
-    for (size_t i = 0; i < metrics.size(); i += batch_size) {
-        auto batch_start = metrics.begin() + i;
-        auto batch_end = metrics.begin() + std::min(i + batch_size, metrics.size());
-        storage.insert_range(batch_start, batch_end);
+// Compares the native MPS reader with the Gurobi reader on every instance
+void check_mps_reader() {
+    vector<string> instance_names = get_instance_names();
+    int mismatches = 0;
+    double native_s = 0.0;
+    double gurobi_s = 0.0;
+    for (string name : instance_names) {
+        try {
+            auto start = chrono::steady_clock::now();
+            MpsCounts counts = countMps(getMpsPath(name));
+            auto native_end = chrono::steady_clock::now();
+            GRBModel model = loadModel(name);
+            int num_bin_vars = getBinaryVariables(model).size();
+            auto gurobi_end = chrono::steady_clock::now();
+            native_s += chrono::duration<double>(native_end - start).count();
+            gurobi_s += chrono::duration<double>(gurobi_end - native_end).count();
+
+            bool match = counts.num_vars == model.get(GRB_IntAttr_NumVars)
+                && counts.num_constrs == model.get(GRB_IntAttr_NumConstrs)
+                && counts.num_nonzeros == model.get(GRB_IntAttr_NumNZs)
+                && counts.num_int_vars == model.get(GRB_IntAttr_NumIntVars)
+                && counts.num_bin_vars == num_bin_vars;
+            if (!match) {
+                mismatches++;
+                fmt::print("Mismatch for {}: vars {}/{}, constrs {}/{}, nnz {}/{}, int {}/{}, bin {}/{} (native/gurobi)\n", 
+                    name, 
+                    counts.num_vars, model.get(GRB_IntAttr_NumVars),
+                    counts.num_constrs, model.get(GRB_IntAttr_NumConstrs),
+                    counts.num_nonzeros, model.get(GRB_IntAttr_NumNZs),
+                    counts.num_int_vars, model.get(GRB_IntAttr_NumIntVars),
+                    counts.num_bin_vars, num_bin_vars);
+            }
+        } catch (exception& e) {
+            mismatches++;
+            fmt::print("Error checking {}: {}\n", name, e.what());
+        } catch (GRBException& e) {
+            mismatches++;
+            fmt::print("Error checking {}: {}\n", name, e.getMessage());
+        }
     }
+    fmt::print("Checked {} instances, {} mismatches. Native reader {:.1f}s, Gurobi {:.1f}s\n", 
+        instance_names.size(), mismatches, native_s, gurobi_s);
 }
 
-optional<vector<int>> get_best_solution_for_instance_from_db(string instance_id) {
-    auto storage = get_storage();
+void batch_insert_metrics(vector<CallbackMetric>& metrics, int batch_size) {
+    TRACE_SPAN("db_insert_metrics");
+    lock_guard<mutex> lock(get_db_mutex());
+    auto& storage = get_storage();
+    storage.transaction([&] {
+        for (size_t i = 0; i < metrics.size(); i += batch_size) {
+            auto batch_start = metrics.begin() + i;
+            auto batch_end = metrics.begin() + std::min(i + batch_size, metrics.size());
+            storage.insert_range(batch_start, batch_end);
+        }
+        return true;
+    });
+}
+
+// The incumbent written by previous runs, or else the best grb_only solution
+string get_content_hash(const string& instance_name) {
+    lock_guard<mutex> lock(get_db_mutex());
+    auto hashes = get_storage().select(&InstanceFile::content_hash, where(c(&InstanceFile::instance_name) == instance_name));
+    return hashes.empty() ? "" : hashes[0];
+}
+
+optional<IncumbentRecord> get_best_incumbent_for_instance_from_db(string instance_id) {
+    TRACE_SPAN("db_best_incumbent");
+    lock_guard<mutex> lock(get_db_mutex());
+    auto& storage = get_storage();
+
+    auto persisted = storage.get_pointer<IncumbentRecord>(instance_id);
+    if (persisted) {
+        return *persisted;
+    }
     
     auto results = storage.select(
         object<GRBAttributes>(),
         join<Job>(on(c(&GRBAttributes::job_id) == &Job::id)),
-        where(c(&Job::instance_id) == instance_id and c(&GRBAttributes::solution) != "" and c(&Job::group_name) == "grb_only"),
+        where(c(&Job::instance_id) == instance_id 
+            and (c(&GRBAttributes::solution) != "" or length(&GRBAttributes::solution_blob) > 0) 
+            and c(&Job::group_name) == "grb_only"),
         order_by(&GRBAttributes::ObjVal).asc(),
         limit(1)
     );
@@ -85,20 +244,62 @@ optional<vector<int>> get_best_solution_for_instance_from_db(string instance_id)
     }
 
     auto& result = results[0];
-    string& solution_str = result.solution;
-    if (solution_str.empty()) {
-        return std::nullopt;
-    }
     fmt::print("Found solution with obj_val: {} for instance: {}\n", (double)result.ObjVal, instance_id);
-    stringstream ss(solution_str);
-    string item;
-    vector<int> solution;
-    while (getline(ss, item, ',')) {
-        if (!item.empty()) {
-            solution.push_back(stoi(item));
+    IncumbentRecord incumbent = {
+        .instance_id = instance_id,
+        .obj_val = result.ObjVal,
+        .job_id = result.job_id,
+        .solution_blob = result.solution_blob,
+    };
+    if (incumbent.solution_blob.empty()) {
+        incumbent.solution_blob = encodeSolution(parseSolutionString(result.solution), 0);
+    }
+    return incumbent;
+}
+
+void save_incumbents(vector<IncumbentRecord>& incumbents) {
+    if (incumbents.empty()) {
+        return;
+    }
+    TRACE_SPAN("db_save_incumbents");
+    lock_guard<mutex> lock(get_db_mutex());
+    auto& storage = get_storage();
+    storage.replace_range(incumbents.begin(), incumbents.end());
+}
+
+// Rewrites the text solutions stored before the binary codec as blobs
+void migrate_solutions(int batch_size) {
+    lock_guard<mutex> lock(get_db_mutex());
+    auto& storage = get_storage();
+    int migrated = 0;
+    while (true) {
+        auto rows = storage.select(
+            columns(&GRBAttributes::id, &GRBAttributes::solution, &Instance::num_bin_variables),
+            join<Job>(on(c(&GRBAttributes::job_id) == &Job::id)),
+            join<Instance>(on(c(&Job::instance_id) == &Instance::id)),
+            where(c(&GRBAttributes::solution) != ""),
+            limit(batch_size)
+        );
+        if (rows.empty()) {
+            break;
         }
+        storage.transaction([&] {
+            for (auto& row : rows) {
+                vector<int> solution = parseSolutionString(std::get<1>(row));
+                vector<char> blob = encodeSolution(solution, std::get<2>(row));
+                storage.update_all(
+                    sqlite_orm::set(c(&GRBAttributes::solution_blob) = blob, c(&GRBAttributes::solution) = ""),
+                    where(c(&GRBAttributes::id) == std::get<0>(row))
+                );
+            }
+            return true;
+        });
+        migrated += rows.size();
+        fmt::print("Migrated {} solutions\n", migrated);
     }
-    return solution;
+    // Give the space of the text solutions back to the file system
+    storage.vacuum();
+    fmt::print("Migrated {} solutions in total\n", migrated);
 }
 
 
@@ -6,6 +6,7 @@
 #include "sqlite_orm/sqlite_orm.h"
 #include <chrono>
 #include <optional>
+#include <mutex>
 
 using namespace std;
 using namespace sqlite_orm;
@@ -26,7 +27,20 @@ struct Instance {
     bool selected = false;
     int num_bin_variables;
     int num_int_variables; 
-    float best_known_obj_val = 1e10;
+    double best_known_obj_val = 1e10; // 1e10 until set_best_obj_val.py ran
+};
+
+// MPS file an instance was seeded from, used to skip unchanged files when re-seeding
+struct InstanceFile {
+    string path;
+    string instance_name;
+    int64_t size;
+    int64_t mtime;
+    string content_hash; // hex of hashFile
+    int num_bin_variables;
+    int num_vars;
+    double load_ms;
+    int64_t seeded_at = unix_now();
 };
 
 // https://docs.gurobi.com/projects/optimizer/en/current/concepts/attributes/types.html#secattributetypes
@@ -45,9 +59,39 @@ struct GRBAttributes {
     int NumConstrs;
     int NumBinVars;
     int NumIntVars;
-    string solution;
+    // Deterministic effort, summed over the sub-MIPs for LNS jobs. -1 on rows written before
+    double Work = -1.0; // Gurobi work units
+    double IterCount = -1.0; // simplex iterations
+    int BarIterCount = -1;
+    string solution; // legacy comma separated indices, see migrate_solutions
+    vector<char> solution_blob; // encoded with solution_codec.h
+    bool winner = false; // job that won its portfolio race
+    double primal_gap_ref = 1e100; // best_known_obj_val primal_gap was computed against
+    double primal_integral = -1.0; // see incumbent_timeline.h, -1 if not computed
+    double time_to_first_s = -1.0;
+    double time_to_target_s = -1.0;
+    // Policy that ended the job early ("stall_time", "stall_nodes", "gap_rate", "best_known", "race") or "none"
+    string termination_reason = "none";
+    // Resource usage of the job, see resource_usage.h. -1 on rows written before.
+    // The process wide fields are only recorded with a single worker, -1 otherwise
+    double cpu_user_s = -1.0; // process CPU time during the job, Gurobi threads included
+    double cpu_sys_s = -1.0;
+    // CPU time of the thread that called optimize, without its Gurobi and helper threads,
+    // so not the job's CPU time
+    double thread_cpu_s = -1.0;
+    double peak_rss_mb = -1.0; // process peak resident set at the end of the job
+    double peak_rss_delta_mb = -1.0; // growth of the peak during the job
+    int64_t minor_faults = -1;
+    int64_t major_faults = -1;
 }; 
 
+// Improving incumbents of a job, encoded with incumbent_timeline.h
+struct IncumbentTimeline {
+    int job_id;
+    int num_events;
+    vector<char> timeline_blob;
+};
+
 struct CallbackMetric {
     int id = -1; 
     int job_id = -1;
@@ -57,30 +101,109 @@ struct CallbackMetric {
     int64_t elapsed_ms;
 };
 
+// Best known solution of an instance, written behind by the IncumbentStore
+struct IncumbentRecord {
+    string instance_id;
+    double obj_val;
+    int job_id = -1;
+    vector<char> solution_blob; // encoded with solution_codec.h
+    int64_t updated_at = unix_now();
+};
+
+struct LNSIteration {
+    int id = -1;
+    int job_id = -1;
+    int iteration;
+    int neighborhood_size; // free binary variables
+    int num_fixed;
+    double sub_mip_time_s;
+    int status;
+    double fixing_time_ms; // time to build and apply the neighborhood
+    double obj_val = 1e100; // no solution found
+    double best_obj_val = 1e100;
+    bool improved = false;
+    int64_t elapsed_ms;
+    string operator_name = "random"; // destroy operator, see adaptive_lns.h
+    double work = 0.0; // Gurobi work units of the sub-MIP
+};
+
+// Per job summary of an adaptive LNS destroy operator
+struct LNSOperatorStats {
+    int id = -1;
+    int job_id = -1;
+    string operator_name;
+    int selections = 0;
+    int improvements = 0;
+    double total_gain = 0.0; // summed objective improvement
+    double total_time_s = 0.0;
+    double value = 0.0; // bandit estimate at the end of the job
+};
+
 struct Job { 
     int id; 
     string instance_id; 
     int time_limit_s = 10;
     string group_name = ""; 
     bool enable_callback = false;
+    int metrics_every_nodes = 1; // sample callback metrics every k explored nodes
+    int metrics_every_ms = 0; // and at least this many milliseconds apart
     bool warm_start = false;
     bool enable_lns = false;
     int seed = 0;
     float fixing_ratio = 0.20; // 20% of the variables are fixed
+    bool iterative_lns = false; // repeat destroy and repair until time_limit_s
+    float sub_mip_time_s = 1.0; // time limit of each iterative LNS sub-MIP
+    string fixing_method = "constraint"; // single fixing row, or "bounds"
+    bool adaptive_lns = false; // iterative LNS picks operators and neighborhood sizes online
+    string neighborhood = "random"; // "random", "bfs", "walk" or "block", see neighborhood.h
+    int lns_helpers = 0; // LNS threads feeding the main solve, see hybrid.h
+    // Early termination, 0 disables a policy (see termination.h)
+    float stall_time_s = 0; // no improvement for this many seconds
+    int stall_nodes = 0; // no improvement for this many nodes
+    float min_gap_rate = 0; // minimum MIP gap closed per second
+    bool stop_at_best_known = false; // stop once best_known_obj_val of the instance is reached
+    int threads = 0; // Gurobi Threads parameter, 0 = all cores
+    // Placement of pinned jobs (--pin), see cpu_topology.h
+    string cpu_set = ""; // logical CPUs, "" when not pinned
+    int numa_node = -1; // -1 when not pinned or spread over several nodes
+    // "time" jobs stop after time_limit_s seconds. "work" jobs stop after limit_value
+    // Gurobi work units, which is deterministic: results do not depend on the load of the host
+    string limit_type = "time";
+    double limit_value = 10; // time_limit_s for time jobs
+    int64_t race_id = 0; // run of the race the job belongs to, 0 outside of races
     int64_t created_at = unix_now();
+    // Queue state, see job_queue.h
+    string status = "pending"; // "pending", "running", "done" or "failed"
+    string params_key = ""; // instance, parameters and seed, shared by reruns of the same job
+    string worker_id = ""; // host:pid of the process holding the lease
+    int64_t lease_expires_at = 0;
+    int64_t heartbeat_at = 0;
+    int attempts = 0;
 }; 
 
 
 void sync_db();
 void seed_instances();
+void check_mps_reader();
 vector<string> get_instance_names();
 vector<Instance> get_instances();
 vector<Instance> get_selected_instances();
 void batch_insert_metrics(vector<CallbackMetric>& metrics, int batch_size = 1000);
-optional<vector<int>> get_best_solution_for_instance_from_db(string instance_id);
+optional<IncumbentRecord> get_best_incumbent_for_instance_from_db(string instance_id);
+string get_content_hash(const string& instance_name); // of the seeded MPS file, "" if unknown
+void save_incumbents(vector<IncumbentRecord>& incumbents);
+void migrate_solutions(int batch_size = 100);
+
+// Serializes access to the single connection shared by the process (get_storage).
+// The connection, its prepared statements and changes() are not safe to use from
+// several threads at once.
+inline mutex& get_db_mutex() {
+    static mutex db_mutex;
+    return db_mutex;
+}
 
-inline auto get_storage() {
-    return make_storage("data/db.sqlite",
+inline auto make_storage_at(const string& path) {
+    return make_storage(path,
         make_table("instances", 
             make_column("id", &Instance::id, primary_key()), 
             make_column("name", &Instance::name),
@@ -90,17 +213,55 @@ inline auto get_storage() {
             make_column("num_int_variables", &Instance::num_int_variables),
             make_column("best_known_obj_val", &Instance::best_known_obj_val)
         ),  
+        make_table("instance_files",
+            make_column("path", &InstanceFile::path, primary_key()),
+            make_column("instance_name", &InstanceFile::instance_name),
+            make_column("size", &InstanceFile::size),
+            make_column("mtime", &InstanceFile::mtime),
+            make_column("content_hash", &InstanceFile::content_hash),
+            make_column("num_bin_variables", &InstanceFile::num_bin_variables),
+            make_column("num_vars", &InstanceFile::num_vars),
+            make_column("load_ms", &InstanceFile::load_ms),
+            make_column("seeded_at", &InstanceFile::seeded_at)
+        ),
         make_table("jobs", 
             make_column("id", &Job::id, primary_key().autoincrement()),
             make_column("instance_id", &Job::instance_id),
             make_column("group_name", &Job::group_name),
             make_column("time_limit_s", &Job::time_limit_s),
             make_column("enable_callback", &Job::enable_callback),
+            make_column("metrics_every_nodes", &Job::metrics_every_nodes, default_value(1)),
+            make_column("metrics_every_ms", &Job::metrics_every_ms, default_value(0)),
             make_column("warm_start", &Job::warm_start),
             make_column("enable_lns", &Job::enable_lns),
             make_column("fixing_ratio", &Job::fixing_ratio),
+            make_column("iterative_lns", &Job::iterative_lns, default_value(false)),
+            make_column("sub_mip_time_s", &Job::sub_mip_time_s, default_value(1.0)),
+            // Jobs created before bound fixing used the fixing row
+            make_column("fixing_method", &Job::fixing_method, default_value("constraint")),
+            make_column("adaptive_lns", &Job::adaptive_lns, default_value(false)),
+            make_column("neighborhood", &Job::neighborhood, default_value("random")),
+            make_column("lns_helpers", &Job::lns_helpers, default_value(0)),
+            make_column("stall_time_s", &Job::stall_time_s, default_value(0)),
+            make_column("stall_nodes", &Job::stall_nodes, default_value(0)),
+            make_column("min_gap_rate", &Job::min_gap_rate, default_value(0)),
+            make_column("stop_at_best_known", &Job::stop_at_best_known, default_value(false)),
             make_column("seed", &Job::seed),
-            make_column("created_at", &Job::created_at)
+            make_column("threads", &Job::threads, default_value(0)),
+            make_column("cpu_set", &Job::cpu_set, default_value("")),
+            make_column("numa_node", &Job::numa_node, default_value(-1)),
+            make_column("limit_type", &Job::limit_type, default_value("time")),
+            // Set to time_limit_s by sync_db on jobs from before work limits
+            make_column("limit_value", &Job::limit_value, default_value(-1.0)),
+            make_column("race_id", &Job::race_id, default_value(0)),
+            make_column("created_at", &Job::created_at),
+            // Jobs from before the queue were only written once finished
+            make_column("status", &Job::status, default_value("done")),
+            make_column("params_key", &Job::params_key, default_value("")),
+            make_column("worker_id", &Job::worker_id, default_value("")),
+            make_column("lease_expires_at", &Job::lease_expires_at, default_value(0)),
+            make_column("heartbeat_at", &Job::heartbeat_at, default_value(0)),
+            make_column("attempts", &Job::attempts, default_value(0))
         ),
         make_table("grb_attributes",
             make_column("id", &GRBAttributes::id, primary_key().autoincrement()),
@@ -113,7 +274,25 @@ inline auto get_storage() {
             make_column("status", &GRBAttributes::Status),
             make_column("obj_val", &GRBAttributes::ObjVal),
             make_column("max_mem_used", &GRBAttributes::MaxMemUsed),
-            make_column("solution", &GRBAttributes::solution)
+            make_column("solution", &GRBAttributes::solution),
+            make_column("solution_blob", &GRBAttributes::solution_blob, default_value("")),
+            make_column("winner", &GRBAttributes::winner, default_value(false)),
+            // Rows from before native primal metrics are stale until set_primal_gap.py runs
+            make_column("primal_gap_ref", &GRBAttributes::primal_gap_ref, default_value(1e100)),
+            make_column("primal_integral", &GRBAttributes::primal_integral, default_value(-1.0)),
+            make_column("time_to_first_s", &GRBAttributes::time_to_first_s, default_value(-1.0)),
+            make_column("time_to_target_s", &GRBAttributes::time_to_target_s, default_value(-1.0)),
+            make_column("termination_reason", &GRBAttributes::termination_reason, default_value("none")),
+            make_column("work", &GRBAttributes::Work, default_value(-1.0)),
+            make_column("iter_count", &GRBAttributes::IterCount, default_value(-1.0)),
+            make_column("bar_iter_count", &GRBAttributes::BarIterCount, default_value(-1)),
+            make_column("cpu_user_s", &GRBAttributes::cpu_user_s, default_value(-1.0)),
+            make_column("cpu_sys_s", &GRBAttributes::cpu_sys_s, default_value(-1.0)),
+            make_column("thread_cpu_s", &GRBAttributes::thread_cpu_s, default_value(-1.0)),
+            make_column("peak_rss_mb", &GRBAttributes::peak_rss_mb, default_value(-1.0)),
+            make_column("peak_rss_delta_mb", &GRBAttributes::peak_rss_delta_mb, default_value(-1.0)),
+            make_column("minor_faults", &GRBAttributes::minor_faults, default_value(-1)),
+            make_column("major_faults", &GRBAttributes::major_faults, default_value(-1))
         ),
         make_table("callback_metrics",
             make_column("id", &CallbackMetric::id, primary_key().autoincrement()),
@@ -122,7 +301,73 @@ inline auto get_storage() {
             make_column("solcnt", &CallbackMetric::solcnt),
             make_column("elapsed_ms", &CallbackMetric::elapsed_ms),
             make_column("job_id", &CallbackMetric::job_id)
-        )
+        ),
+        make_table("incumbents",
+            make_column("instance_id", &IncumbentRecord::instance_id, primary_key()),
+            make_column("obj_val", &IncumbentRecord::obj_val),
+            make_column("job_id", &IncumbentRecord::job_id),
+            make_column("solution_blob", &IncumbentRecord::solution_blob),
+            make_column("updated_at", &IncumbentRecord::updated_at)
+        ),
+        make_table("lns_iterations",
+            make_column("id", &LNSIteration::id, primary_key().autoincrement()),
+            make_column("job_id", &LNSIteration::job_id),
+            make_column("iteration", &LNSIteration::iteration),
+            make_column("neighborhood_size", &LNSIteration::neighborhood_size),
+            make_column("num_fixed", &LNSIteration::num_fixed),
+            make_column("sub_mip_time_s", &LNSIteration::sub_mip_time_s),
+            make_column("status", &LNSIteration::status),
+            make_column("fixing_time_ms", &LNSIteration::fixing_time_ms),
+            make_column("obj_val", &LNSIteration::obj_val),
+            make_column("best_obj_val", &LNSIteration::best_obj_val),
+            make_column("improved", &LNSIteration::improved),
+            make_column("elapsed_ms", &LNSIteration::elapsed_ms),
+            make_column("operator_name", &LNSIteration::operator_name, default_value("random")),
+            make_column("work", &LNSIteration::work, default_value(0.0))
+        ),
+        make_table("incumbent_timelines",
+            make_column("job_id", &IncumbentTimeline::job_id, primary_key()),
+            make_column("num_events", &IncumbentTimeline::num_events),
+            make_column("timeline_blob", &IncumbentTimeline::timeline_blob)
+        ),
+        make_table("lns_operator_stats",
+            make_column("id", &LNSOperatorStats::id, primary_key().autoincrement()),
+            make_column("job_id", &LNSOperatorStats::job_id),
+            make_column("operator_name", &LNSOperatorStats::operator_name),
+            make_column("selections", &LNSOperatorStats::selections),
+            make_column("improvements", &LNSOperatorStats::improvements),
+            make_column("total_gain", &LNSOperatorStats::total_gain),
+            make_column("total_time_s", &LNSOperatorStats::total_time_s),
+            make_column("value", &LNSOperatorStats::value)
+        ),
+        make_index("jobs_instance_group_idx", &Job::instance_id, &Job::group_name),
+        make_index("jobs_params_key_idx", &Job::params_key),
+        make_index("grb_attributes_job_idx", &GRBAttributes::job_id)
     );
 }
 
+using Storage = decltype(make_storage_at(""));
+
+// Keeps the connection open for the whole process. WAL lets the dashboard read
+// while jobs write and makes NORMAL synchronous safe against corruption.
+inline void tune_storage(Storage& storage) {
+    storage.on_open = [](sqlite3* db) {
+        sqlite3_exec(db, 
+            "PRAGMA journal_mode=WAL;"
+            "PRAGMA synchronous=NORMAL;"
+            "PRAGMA temp_store=MEMORY;"
+            "PRAGMA cache_size=-65536;"
+            "PRAGMA busy_timeout=5000;", 
+            nullptr, nullptr, nullptr);
+    };
+    storage.open_forever();
+}
+
+// Single long lived connection shared by the process, guard it with get_db_mutex()
+inline Storage& get_storage() {
+    static Storage storage = make_storage_at("data/db.sqlite");
+    static once_flag opened;
+    call_once(opened, []() { tune_storage(storage); });
+    return storage;
+}
+
@@ -0,0 +1,308 @@
+#include "distributed.h"
+#include "cpu_topology.h"
+#include "executor.h"
+#include "grb_env.h"
+#include "incumbent_store.h"
+#include "job_queue.h"
+#include "model_cache.h"
+#include "net.h"
+#include "result_sink.h"
+#include "solution_codec.h"
+#include "solve_mps.h"
+#include "thread_pool.h"
+#include "wire.h"
+#include "fmt/core.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+// A worker is considered gone when nothing arrived for this long. Workers send a
+// heartbeat every WORKER_HEARTBEAT_MS while they solve.
+const int WORKER_TIMEOUT_MS = 60000;
+const int WORKER_HEARTBEAT_MS = 10000;
+const int WORKER_WAIT_MS = 2000;
+
+static vector<char> encodeJobMessage(const Job& job, const optional<Instance>& instance, shared_ptr<const Incumbent> incumbent,
+    const string& content_hash) {
+    WireWriter writer;
+    putRecord(writer, job);
+    writer.put(instance.has_value());
+    if (instance) {
+        putRecord(writer, *instance);
+    }
+    writer.put(incumbent != nullptr);
+    if (incumbent) {
+        writer(incumbent->obj_val, incumbent->solution, incumbent->job_id);
+    }
+    writer.put(content_hash);
+    return writer.buffer;
+}
+
+static vector<char> encodeResultMessage(const Job& job, const JobResults& results) {
+    WireWriter writer;
+    writer(job.id, job.threads, job.cpu_set, job.numa_node, results.sense);
+    putRecord(writer, results.attributes);
+    putRecord(writer, results.timeline);
+    putRecords(writer, results.lns_iterations);
+    putRecords(writer, results.operator_stats);
+    return writer.buffer;
+}
+
+// One thread per worker connection, a connection solves one job at a time
+static void handleWorker(int fd, JobQueue& queue) {
+    Connection connection(fd);
+    string worker_name = "unknown";
+    optional<Job> current;
+    uint8_t type;
+    vector<char> payload;
+    while (connection.receive(type, payload, WORKER_TIMEOUT_MS)) {
+        try {
+            WireReader reader(payload);
+            if (type == MSG_HELLO) {
+                reader(worker_name);
+                fmt::print("Worker {} connected\n", worker_name);
+            } else if (type == MSG_REQUEST_JOB) {
+                if (current) {
+                    throw runtime_error("job requested before the previous one ended");
+                }
+                current = queue.claim();
+                if (!current) {
+                    connection.send(queue.numRemaining() == 0 ? MSG_DONE : MSG_WAIT);
+                    continue;
+                }
+                fmt::print("Sending job {} ({}) to {}\n", current->id, current->instance_id, worker_name);
+                connection.send(MSG_JOB, encodeJobMessage(*current,
+                    getDbSink().getInstance(current->instance_id),
+                    IncumbentStore::getInstance().get(current->instance_id),
+                    get_content_hash(current->instance_id)));
+            } else if (type == MSG_METRICS && current) {
+                vector<CallbackMetric> metrics;
+                getRecords(reader, metrics);
+                for (CallbackMetric& metric : metrics) {
+                    metric.job_id = current->id;
+                }
+                getDbSink().writeMetrics(metrics);
+            } else if (type == MSG_RESULT && current) {
+                int job_id;
+                JobResults results;
+                reader(job_id, current->threads, current->cpu_set, current->numa_node, results.sense);
+                getRecord(reader, results.attributes);
+                getRecord(reader, results.timeline);
+                getRecords(reader, results.lns_iterations);
+                getRecords(reader, results.operator_stats);
+                if (job_id != current->id) {
+                    throw runtime_error(fmt::format("result of job {} while job {} is running", job_id, current->id));
+                }
+                if (results.attributes.SolCount > 0 && !results.attributes.solution_blob.empty()) {
+                    results.solution = decodeSolution(results.attributes.solution_blob);
+                }
+                getDbSink().writeResults(*current, results);
+                queue.release(*current);
+                fmt::print("Job {} done by {}: objective {}\n", current->id, worker_name, results.attributes.ObjVal);
+                current.reset();
+            } else if (type == MSG_FAILED && current) {
+                fmt::print("Job {} failed on {}\n", current->id, worker_name);
+                queue.release(*current);
+                current.reset();
+            }
+        } catch (exception& e) {
+            fmt::print("Dropping worker {}: {}\n", worker_name, e.what());
+            break;
+        }
+    }
+    if (current) {
+        bool requeued = queue.requeue(*current);
+        fmt::print("Worker {} lost during job {}, {}\n", worker_name, current->id, requeued ? "requeued" : "giving up");
+    }
+}
+
+void serveJobs(vector<Job>& jobs, const string& address) {
+    JobQueue queue(getExecutorConfig().lease_s);
+    queue.enqueue(jobs);
+    if (queue.numRemaining() == 0) {
+        return;
+    }
+
+    int listen_fd = listenOn(address);
+    fmt::print("Coordinator listening on {}, start workers with -a worker --coordinator {}\n", address, address);
+    vector<thread> handlers;
+    int64_t last_report = 0;
+    while (true) {
+        int fd = acceptConnection(listen_fd, 1000);
+        if (fd >= 0) {
+            handlers.emplace_back(handleWorker, fd, ref(queue));
+            continue;
+        }
+        int remaining = queue.numRemaining();
+        if (remaining == 0) {
+            break;
+        }
+        if (unix_now() - last_report >= 60) {
+            fmt::print("Coordinator: {} jobs left\n", remaining);
+            last_report = unix_now();
+        }
+    }
+    closeListener(listen_fd, address);
+    // Connected workers get DONE on their next request
+    for (thread& handler : handlers) {
+        handler.join();
+    }
+}
+
+// Results go back over the worker's connection instead of into a database
+class RemoteSink : public ResultSink {
+    public:
+        RemoteSink(Connection& connection, optional<Instance> instance) : connection(connection), instance(instance) {}
+
+        optional<Instance> getInstance(const string&) override { return instance; }
+
+        void writeMetrics(vector<CallbackMetric>& metrics) override {
+            WireWriter writer;
+            putRecords(writer, metrics);
+            connection.send(MSG_METRICS, writer.buffer);
+        }
+
+        void writeResults(Job& job, JobResults& results) override {
+            sent = connection.send(MSG_RESULT, encodeResultMessage(job, results));
+            if (results.attributes.SolCount > 0) {
+                IncumbentStore::getInstance().offer(job.instance_id, results.attributes.ObjVal, results.solution, results.sense, job.id);
+            }
+        }
+
+        bool resultSent() const { return sent; }
+
+    private:
+        Connection& connection;
+        optional<Instance> instance;
+        bool sent = false;
+};
+
+// Connection with retries, so workers can be started before the coordinator
+static unique_ptr<Connection> connectWithRetry(const string& address, int attempts = 30) {
+    for (int attempt = 1; ; attempt++) {
+        try {
+            return make_unique<Connection>(connectTo(address));
+        } catch (runtime_error& e) {
+            if (attempt == attempts) {
+                throw;
+            }
+            this_thread::sleep_for(chrono::seconds(2));
+        }
+    }
+}
+
+static void workerLoop(const string& address, int worker_id, int threads, const CpuPlacement* placement) {
+    optional<ThreadPinning> pinning;
+    if (placement) {
+        pinning.emplace(placement->cpus);
+        threads = placement->num_cores;
+    }
+    unique_ptr<Connection> connection = connectWithRetry(address);
+    char host[256] = "localhost";
+    gethostname(host, sizeof(host) - 1);
+    WireWriter hello;
+    hello.put(fmt::format("{}:{}/{}", host, getpid(), worker_id));
+    connection->send(MSG_HELLO, hello.buffer);
+
+    unique_ptr<GRBEnv> env;
+    uint8_t type;
+    vector<char> payload;
+    while (connection->send(MSG_REQUEST_JOB) && connection->receive(type, payload)) {
+        if (type == MSG_DONE) {
+            fmt::print("[worker {}] Campaign done\n", worker_id);
+            return;
+        }
+        if (type == MSG_WAIT) {
+            this_thread::sleep_for(chrono::milliseconds(WORKER_WAIT_MS));
+            continue;
+        }
+        if (type != MSG_JOB) {
+            continue;
+        }
+
+        Job job;
+        optional<Instance> instance;
+        WireReader reader(payload);
+        getRecord(reader, job);
+        bool has_instance, has_incumbent;
+        reader(has_instance);
+        if (has_instance) {
+            instance.emplace();
+            getRecord(reader, *instance);
+        }
+        reader(has_incumbent);
+        // Replaces what earlier jobs of this worker found, the coordinator decides the start
+        shared_ptr<Incumbent> incumbent;
+        if (has_incumbent) {
+            incumbent = make_shared<Incumbent>();
+            reader(incumbent->obj_val, incumbent->solution, incumbent->job_id);
+        }
+        IncumbentStore::getInstance().set(job.instance_id, incumbent);
+        string content_hash;
+        reader(content_hash);
+        ModelCache::getInstance().setContentHash(job.instance_id, content_hash);
+
+        // Heartbeats keep the coordinator from requeueing the job during long solves
+        mutex heartbeat_mutex;
+        condition_variable solved;
+        bool done = false;
+        thread heartbeat([&]() {
+            unique_lock<mutex> lock(heartbeat_mutex);
+            while (!solved.wait_for(lock, chrono::milliseconds(WORKER_HEARTBEAT_MS), [&] { return done; })) {
+                connection->send(MSG_HEARTBEAT);
+            }
+        });
+
+        RemoteSink sink(*connection, instance);
+        try {
+            if (!env) {
+                env = GurobiEnvironment::createEnv(threads, false);
+            }
+            fmt::print("[worker {}] Solving job {}: {}\n", worker_id, job.id, job.instance_id);
+            job.threads = threads;
+            setPlacement(job, pinning && pinning->pinned() ? placement : nullptr);
+            solveJob(job, *env, sink);
+        } catch (GRBException& e) {
+            fmt::print("[worker {}] Error: {}\n", worker_id, e.getMessage());
+        } catch (exception& e) {
+            fmt::print("[worker {}] Error: {}\n", worker_id, e.what());
+        }
+        {
+            lock_guard<mutex> lock(heartbeat_mutex);
+            done = true;
+        }
+        solved.notify_all();
+        heartbeat.join();
+        if (!sink.resultSent()) {
+            WireWriter failed;
+            failed.put(job.id);
+            connection->send(MSG_FAILED, failed.buffer);
+        }
+    }
+    fmt::print("[worker {}] Lost the coordinator\n", worker_id);
+}
+
+void runWorker(const string& address) {
+    if (address.empty()) {
+        throw runtime_error("The worker action needs --coordinator <address>");
+    }
+    // Incumbents come with the jobs, the coordinator persists them
+    IncumbentStore::getInstance().setPersistent(false);
+    ExecutorConfig& config = getExecutorConfig();
+    int workers = max(1, config.workers);
+    int threads = getThreadsPerJob(config);
+    vector<CpuPlacement> placements = planPlacements(config, workers);
+    parallel_for(workers, workers, [&](int, int worker_id) {
+        try {
+            workerLoop(address, worker_id, threads, placements.empty() ? nullptr : &placements[worker_id]);
+        } catch (exception& e) {
+            fmt::print("[worker {}] {}\n", worker_id, e.what());
+        }
+    });
+}
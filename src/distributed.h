@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "db.h"
+
+using namespace std;
+
+// Coordinator/worker mode. The coordinator is a normal experiment action started
+// with --coordinator <address>: it owns the database, enqueues its job grid in the
+// JobQueue and hands the jobs out to worker processes (`-a worker --coordinator
+// <address>`) instead of solving them. Workers stream callback metrics while they
+// solve and send the results when a job ends, the coordinator writes them.
+// A worker that disconnects or goes silent has its job put back in the queue.
+//
+// Protocol, framed by Connection (net.h) and encoded with wire.h:
+//   worker -> coordinator: HELLO name, REQUEST_JOB, HEARTBEAT, METRICS, RESULT, FAILED
+//   coordinator -> worker: JOB (job, instance, incumbent), WAIT, DONE
+enum MessageType : uint8_t {
+    MSG_HELLO = 1,
+    MSG_REQUEST_JOB = 2,
+    MSG_JOB = 3,
+    MSG_WAIT = 4, // nothing to claim right now, ask again later
+    MSG_DONE = 5, // every job of the campaign is done or failed
+    MSG_HEARTBEAT = 6,
+    MSG_METRICS = 7,
+    MSG_RESULT = 8,
+    MSG_FAILED = 9,
+};
+
+// Serves the jobs to workers until all of them are done or failed
+void serveJobs(vector<Job>& jobs, const string& address);
+// Solves jobs of the coordinator at address on getExecutorConfig().workers threads
+void runWorker(const string& address);
@@ -0,0 +1,136 @@
+#include "executor.h"
+#include "distributed.h"
+#include "grb_env.h"
+#include "thread_pool.h"
+#include "incumbent_store.h"
+#include "job_queue.h"
+#include "fmt/core.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <thread>
+
+using namespace std;
+
+ExecutorConfig& getExecutorConfig() {
+    static ExecutorConfig config;
+    return config;
+}
+
+int getThreadsPerJob(const ExecutorConfig& config) {
+    if (config.threads_per_job > 0) {
+        return config.threads_per_job;
+    }
+    // Gurobi is only deterministic for a given thread count
+    if (config.work_limit > 0) {
+        return 1;
+    }
+    if (config.workers <= 1) {
+        return 0;
+    }
+    int cores = max(1, (int)thread::hardware_concurrency());
+    return max(1, cores / config.workers);
+}
+
+vector<CpuPlacement> planPlacements(const ExecutorConfig& config, int workers) {
+    if (!config.pin_cpus) {
+        return {};
+    }
+    CpuTopology topology = detectTopology();
+    int num_cores = topology.cores.size();
+    // Explicit and deterministic thread counts are kept, otherwise the physical cores are split
+    int cores_per_worker = config.threads_per_job > 0 || config.work_limit > 0
+        ? getThreadsPerJob(config) : max(1, num_cores / workers);
+    vector<CpuPlacement> placements = placeWorkers(topology, workers, cores_per_worker);
+    if ((int)placements.size() < workers) {
+        fmt::print("Not pinning: {} workers of {} cores do not fit on {} cores\n", workers, cores_per_worker, num_cores);
+        return {};
+    }
+    fmt::print("Pinning {} workers on {} cores, {} CPUs, {} NUMA nodes\n", workers, num_cores, topology.num_cpus, topology.num_nodes);
+    for (int worker_id = 0; worker_id < workers; worker_id++) {
+        fmt::print("  worker {}: CPUs {} (node {})\n", worker_id, formatCpuList(placements[worker_id].cpus), placements[worker_id].numa_node);
+    }
+    return placements;
+}
+
+void setPlacement(Job& job, const CpuPlacement* placement) {
+    job.cpu_set = placement ? formatCpuList(placement->cpus) : "";
+    job.numa_node = placement ? placement->numa_node : -1;
+}
+
+void runJobs(vector<Job>& jobs, const function<void(Job&, GRBEnv&)>& solve, bool distributable) {
+    ExecutorConfig& config = getExecutorConfig();
+    int workers = max(1, config.workers);
+    int threads = getThreadsPerJob(config);
+    fmt::print("Running {} jobs on {} workers ({} threads per job)\n", 
+        jobs.size(), workers, threads == 0 ? "all" : to_string(threads));
+
+    for (Job& job : jobs) {
+        if (config.work_limit > 0) {
+            job.limit_type = "work";
+            job.limit_value = config.work_limit;
+        } else {
+            job.limit_type = "time";
+            job.limit_value = job.time_limit_s;
+        }
+    }
+    if (config.work_limit > 0) {
+        fmt::print("Work limit of {} units per job\n", config.work_limit);
+        bool timed = any_of(jobs.begin(), jobs.end(), [](const Job& job) {
+            return (job.stall_time_s > 0 && !job.iterative_lns) || job.min_gap_rate > 0 || job.lns_helpers > 0;
+        });
+        if (timed) {
+            fmt::print("Warning: stall time, gap rate and LNS helper jobs depend on wall time and are not deterministic\n");
+        }
+        // Jobs that finish first must not change the start of the others
+        IncumbentStore::getInstance().setFrozen(true);
+    }
+
+    // Jobs on the same instance run back to back so they share the cached model
+    stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {
+        return a.instance_id < b.instance_id;
+    });
+
+    if (!config.coordinator_address.empty()) {
+        if (distributable) {
+            serveJobs(jobs, config.coordinator_address);
+            IncumbentStore::getInstance().flush();
+            return;
+        }
+        fmt::print("These jobs need their own solve function, running them locally\n");
+    }
+
+    vector<CpuPlacement> placements = planPlacements(config, workers);
+    JobQueue queue(config.lease_s);
+    int job_count = queue.enqueue(jobs).size();
+    // Interleaved Gurobi logs are unreadable, only keep them for serial runs
+    bool output = workers == 1;
+    vector<unique_ptr<GRBEnv>> envs(workers);
+    atomic<int> started{0};
+    parallel_for(workers, workers, [&](int, int worker_id) {
+        // The Gurobi threads are created by this thread and inherit its CPU mask,
+        // memory is allocated on the node the worker runs on
+        const CpuPlacement* placement = placements.empty() ? nullptr : &placements[worker_id];
+        optional<ThreadPinning> pinning;
+        if (placement) {
+            pinning.emplace(placement->cpus);
+        }
+        int worker_threads = placement ? placement->num_cores : threads;
+        while (optional<Job> job = queue.claim()) {
+            try {
+                if (!envs[worker_id]) {
+                    envs[worker_id] = GurobiEnvironment::createEnv(worker_threads, output);
+                }
+                fmt::print("[worker {}] Solving job {}/{}: {} (id {})\n", worker_id, ++started, job_count, job->instance_id, job->id);
+                job->threads = worker_threads;
+                setPlacement(*job, pinning && pinning->pinned() ? placement : nullptr);
+                solve(*job, *envs[worker_id]);
+            } catch (GRBException e) {
+                fmt::print("[worker {}] Error: {}\n", worker_id, e.getMessage());
+            }
+            queue.release(*job);
+        }
+    });
+    IncumbentStore::getInstance().flush();
+}
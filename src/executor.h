@@ -0,0 +1,40 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "cpu_topology.h"
+#include "db.h"
+#include "gurobi_c++.h"
+
+using namespace std;
+
+struct ExecutorConfig {
+    int workers = 1;
+    int threads_per_job = 0; // 0 splits the machine's cores evenly between workers, or 1 with a work limit
+    int lease_s = 60; // job lease, renewed by the heartbeat while the job runs
+    // Gurobi work units per job, 0 keeps the time limits of the jobs. See runJobs
+    double work_limit = 0;
+    bool pin_cpus = false; // pin every worker to its own cores, see planPlacements
+    string coordinator_address = ""; // serve jobs to worker processes instead of solving them, see distributed.h
+};
+
+ExecutorConfig& getExecutorConfig();
+int getThreadsPerJob(const ExecutorConfig& config);
+// With pin_cpus, one disjoint core set per worker sized like getThreadsPerJob in physical
+// cores. Empty when pinning is off or the machine has too few cores for the workers.
+vector<CpuPlacement> planPlacements(const ExecutorConfig& config, int workers);
+// Records the placement of a job solved by a pinned worker, nullptr for unpinned ones
+void setPlacement(Job& job, const CpuPlacement* placement);
+
+// Runs the jobs on getExecutorConfig().workers threads. Every worker owns a
+// private GRBEnv configured with the per-job thread budget.
+// Jobs go through the JobQueue: completed ones are skipped, and other processes
+// running the same campaign share the work. Jobs are ordered by instance so that
+// the model cache stays warm.
+// With a work limit the jobs become deterministic: they are limited in Gurobi work units,
+// start from the incumbents known before the run and use the same thread count whatever
+// the number of workers, so concurrent runs reproduce serial ones.
+// With a coordinator address the jobs are served to worker processes, which solve them
+// with solveJob. Actions with their own solve function pass distributable = false.
+void runJobs(vector<Job>& jobs, const function<void(Job&, GRBEnv&)>& solve, bool distributable = true);
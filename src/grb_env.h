@@ -1,5 +1,8 @@
 #pragma once
 #include "gurobi_c++.h"
+#include <memory>
+
+using namespace std;
 
 class GurobiEnvironment {
     public:
@@ -13,4 +16,15 @@ class GurobiEnvironment {
             }
             return env;
         }
-    };
\ No newline at end of file
+
+        // Private environment for a worker thread. Gurobi environments are not
+        // thread safe, so every concurrent job needs its own.
+        // threads = 0 keeps the Gurobi default (use all cores).
+        static unique_ptr<GRBEnv> createEnv(int threads = 0, bool output = true) {
+            auto env = make_unique<GRBEnv>(true);
+            env->set(GRB_IntParam_OutputFlag, output ? 1 : 0);
+            env->set(GRB_IntParam_Threads, threads);
+            env->start();
+            return env;
+        }
+    };
@@ -0,0 +1,155 @@
+#include "hybrid.h"
+#include "bound_fixer.h"
+#include "grb_env.h"
+#include "model_cache.h"
+#include "lns.h"
+#include "neighborhood.h"
+#include "solution_exchange.h"
+#include "trace.h"
+#include "utils.h"
+#include "fmt/core.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+// Ends helper sub-MIPs as soon as the main solve is done
+class StopCallback: public GRBCallback {
+  public:
+    explicit StopCallback(atomic<bool>& stop) : stop(stop) {}
+
+  protected:
+    void callback() {
+      if (stop.load(memory_order_relaxed)) {
+        abort();
+      }
+    }
+
+  private:
+    atomic<bool>& stop;
+};
+
+static void runHelper(int helper, Job& job, SolutionExchange& exchange, atomic<bool>& stop, 
+    chrono::steady_clock::time_point start_time, vector<LNSIteration>& iterations) {
+    unique_ptr<GRBEnv> env = GurobiEnvironment::createEnv(1, false);
+    unique_ptr<GRBModel> model = ModelCache::getInstance().getModel(job.instance_id, *env);
+    model->set(GRB_IntParam_Seed, job.seed + helper + 1);
+    setJobLimit(*model, job, jobBudget(job, job.sub_mip_time_s));
+    ModelArrays arrays(*model);
+    int num_binary_variables = arrays.binary_vars.size();
+    BoundFixer fixer(*model, arrays.binary_vars);
+    StopCallback stop_callback(stop);
+    model->setCallback(&stop_callback);
+
+    optional<NeighborhoodGenerator> generator;
+    if (job.neighborhood != "random") {
+        generator.emplace(ModelCache::getInstance().getVarConstraintIndex(job.instance_id, *model, arrays.binary_vars));
+    }
+    mt19937 rng(job.seed * 1000 + helper);
+    string name = fmt::format("helper_{}", helper);
+
+    while (!stop.load(memory_order_relaxed)) {
+        shared_ptr<const ExchangeSolution> solution = exchange.latest();
+        if (!solution) {
+            this_thread::sleep_for(chrono::milliseconds(10));
+            continue;
+        }
+
+        auto fixing_start = chrono::steady_clock::now();
+        vector<double> binary_values(num_binary_variables);
+        for (int i = 0; i < num_binary_variables; i++) {
+            binary_values[i] = solution->values[arrays.binary_indices[i]] > 0.5 ? 1.0 : 0.0;
+        }
+        vector<int> fixing_indices;
+        if (generator) {
+            int num_free = num_binary_variables - (int)(num_binary_variables * job.fixing_ratio);
+            fixing_indices = generator->generate(job.neighborhood, num_free, rng);
+        } else {
+            fixing_indices = sample_percentage(num_binary_variables, job.fixing_ratio, rng);
+        }
+        fixer.fix(fixing_indices, binary_values);
+        model->set(GRB_DoubleAttr_Start, arrays.vars.get(), solution->values.data(), arrays.num_vars);
+        double fixing_time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - fixing_start).count();
+
+        {
+            TRACE_SPAN("helper_sub_mip");
+            model->optimize();
+        }
+
+        LNSIteration record = {
+            .iteration = (int)iterations.size(),
+            .neighborhood_size = num_binary_variables - (int)fixing_indices.size(),
+            .num_fixed = (int)fixing_indices.size(),
+            .sub_mip_time_s = model->get(GRB_DoubleAttr_Runtime),
+            .status = model->get(GRB_IntAttr_Status),
+            .fixing_time_ms = fixing_time_ms,
+            .operator_name = name,
+            .work = model->get(GRB_DoubleAttr_Work),
+        };
+        if (model->get(GRB_IntAttr_SolCount) > 0) {
+            record.obj_val = model->get(GRB_DoubleAttr_ObjVal);
+            if (exchange.isBetter(record.obj_val, solution->obj_val)) {
+                vector<double> x = getAttrArray(*model, GRB_DoubleAttr_X, arrays.vars.get(), arrays.num_vars);
+                record.improved = exchange.publish(record.obj_val, move(x), helper);
+            }
+        }
+        fixer.restore();
+
+        record.best_obj_val = exchange.latest()->obj_val;
+        record.elapsed_ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start_time).count();
+        iterations.push_back(record);
+    }
+}
+
+vector<LNSIteration> runHybrid(GRBModel& model, Job& job, ModelArrays& arrays, CallbackState& callback_state) {
+    SolutionExchange exchange(model.get(GRB_IntAttr_ModelSense));
+    callback_state.setExchange(&exchange, arrays.vars.get(), arrays.num_vars);
+    model.setCallback(&callback_state);
+    // Each helper runs one Gurobi thread, the main solve gets the rest of the job's cores
+    int threads = model.get(GRB_IntParam_Threads);
+    if (threads == 0) {
+        threads = max(1, (int)thread::hardware_concurrency());
+    }
+    model.set(GRB_IntParam_Threads, max(1, threads - job.lns_helpers));
+
+    atomic<bool> stop{false};
+    auto start_time = chrono::steady_clock::now();
+    vector<vector<LNSIteration>> helper_iterations(job.lns_helpers);
+    vector<thread> helpers;
+    for (int helper = 0; helper < job.lns_helpers; helper++) {
+        helpers.emplace_back([&, helper]() {
+            TRACE_THREAD(job.id);
+            try {
+                runHelper(helper, job, exchange, stop, start_time, helper_iterations[helper]);
+            } catch (GRBException e) {
+                fmt::print("LNS helper {} error: {}\n", helper, e.getMessage());
+            }
+        });
+    }
+
+    {
+        TRACE_SPAN("optimize");
+        model.optimize();
+    }
+
+    stop = true;
+    for (thread& helper : helpers) {
+        helper.join();
+    }
+
+    vector<LNSIteration> iterations;
+    int improved_count = 0;
+    for (auto& helper : helper_iterations) {
+        for (LNSIteration& record : helper) {
+            improved_count += record.improved;
+            iterations.push_back(record);
+        }
+    }
+    fmt::print("LNS helpers solved {} sub-MIPs, {} improved the shared incumbent\n", iterations.size(), improved_count);
+    callback_state.printSummary();
+    return iterations;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <vector>
+#include "callback_state.h"
+#include "db.h"
+#include "model_arrays.h"
+#include "gurobi_c++.h"
+
+using namespace std;
+
+// Solves the full model with Gurobi while job.lns_helpers threads run LNS sub-MIPs
+// around the shared incumbent. The main solve publishes its incumbents from MIPSOL,
+// helpers publish improvements that the main solve picks up at its next MIPNODE.
+// Every helper runs single threaded on its own environment and model copy.
+// Returns one LNSIteration per helper sub-MIP, named helper_k.
+vector<LNSIteration> runHybrid(GRBModel& model, Job& job, ModelArrays& arrays, CallbackState& callback_state);
@@ -0,0 +1,148 @@
+#include "incumbent_store.h"
+#include "solution_codec.h"
+#include "trace.h"
+#include "gurobi_c++.h"
+#include "fmt/core.h"
+
+using namespace std;
+
+IncumbentStore& IncumbentStore::getInstance() {
+    static IncumbentStore store;
+    return store;
+}
+
+IncumbentStore::~IncumbentStore() {
+    {
+        lock_guard<mutex> lock(writer_mutex);
+        stopping = true;
+    }
+    writer_cv.notify_all();
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+shared_ptr<IncumbentStore::Slot> IncumbentStore::getSlot(const string& instance_id) {
+    {
+        shared_lock<shared_mutex> lock(slots_mutex);
+        auto it = slots.find(instance_id);
+        if (it != slots.end()) {
+            return it->second;
+        }
+    }
+    unique_lock<shared_mutex> lock(slots_mutex);
+    auto& slot = slots[instance_id];
+    if (!slot) {
+        slot = make_shared<Slot>();
+    }
+    return slot;
+}
+
+shared_ptr<const Incumbent> IncumbentStore::get(const string& instance_id) {
+    shared_ptr<Slot> slot = getSlot(instance_id);
+    call_once(slot->loaded, [&]() {
+        if (!persistent) {
+            return;
+        }
+        TRACE_SPAN("incumbent_load");
+        auto record = get_best_incumbent_for_instance_from_db(instance_id);
+        if (!record) {
+            return;
+        }
+        try {
+            auto incumbent = make_shared<Incumbent>();
+            incumbent->obj_val = record->obj_val;
+            incumbent->solution = decodeSolution(record->solution_blob);
+            incumbent->job_id = record->job_id;
+            lock_guard<mutex> lock(slot->slot_mutex);
+            slot->best = incumbent;
+            slot->initial = incumbent;
+        } catch (runtime_error& e) {
+            fmt::print("Error decoding incumbent of {}: {}\n", instance_id, e.what());
+        }
+    });
+    lock_guard<mutex> lock(slot->slot_mutex);
+    return frozen ? slot->initial : slot->best;
+}
+
+bool IncumbentStore::offer(const string& instance_id, double obj_val, const vector<int>& solution, int sense, int job_id) {
+    // Make sure the persisted incumbent is known before comparing against it
+    get(instance_id);
+    shared_ptr<Slot> slot = getSlot(instance_id);
+    {
+        lock_guard<mutex> lock(slot->slot_mutex);
+        if (slot->best) {
+            double best = slot->best->obj_val;
+            bool better = sense == GRB_MAXIMIZE ? obj_val > best : obj_val < best;
+            if (!better) {
+                return false;
+            }
+        }
+        slot->best = make_shared<Incumbent>(Incumbent{obj_val, solution, job_id});
+    }
+    fmt::print("New incumbent for {}: {}\n", instance_id, obj_val);
+    if (!persistent) {
+        return true;
+    }
+
+    lock_guard<mutex> lock(writer_mutex);
+    dirty.insert(instance_id);
+    if (!writer.joinable()) {
+        writer = thread(&IncumbentStore::writeLoop, this);
+    }
+    writer_cv.notify_one();
+    return true;
+}
+
+void IncumbentStore::set(const string& instance_id, shared_ptr<const Incumbent> incumbent) {
+    shared_ptr<Slot> slot = getSlot(instance_id);
+    call_once(slot->loaded, []() {});
+    lock_guard<mutex> lock(slot->slot_mutex);
+    slot->best = incumbent;
+    slot->initial = incumbent;
+}
+
+void IncumbentStore::flush() {
+    unique_lock<mutex> lock(writer_mutex);
+    flushed_cv.wait(lock, [&]() { return dirty.empty() && !writing; });
+}
+
+void IncumbentStore::writeLoop() {
+    unique_lock<mutex> lock(writer_mutex);
+    while (true) {
+        writer_cv.wait(lock, [&]() { return stopping || !dirty.empty(); });
+        if (dirty.empty() && stopping) {
+            return;
+        }
+        vector<string> instance_ids(dirty.begin(), dirty.end());
+        dirty.clear();
+        writing = true;
+        lock.unlock();
+
+        // Only the latest incumbent of every instance is written
+        vector<IncumbentRecord> records;
+        for (const string& instance_id : instance_ids) {
+            shared_ptr<const Incumbent> incumbent;
+            {
+                shared_ptr<Slot> slot = getSlot(instance_id);
+                lock_guard<mutex> slot_lock(slot->slot_mutex);
+                incumbent = slot->best;
+            }
+            records.push_back({
+                .instance_id = instance_id,
+                .obj_val = incumbent->obj_val,
+                .job_id = incumbent->job_id,
+                .solution_blob = encodeSolution(incumbent->solution, 0),
+            });
+        }
+        try {
+            save_incumbents(records);
+        } catch (exception& e) {
+            fmt::print("Error saving incumbents: {}\n", e.what());
+        }
+
+        lock.lock();
+        writing = false;
+        flushed_cv.notify_all();
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "db.h"
+
+using namespace std;
+
+struct Incumbent {
+    double obj_val;
+    vector<int> solution; // indices of the non zero binary variables
+    int job_id = -1;
+};
+
+// Process wide best solution per instance. The first lookup of an instance 
+// reads it from SQLite, later lookups are served from memory. Jobs offer their
+// final solution and new bests are persisted to the incumbents table by a 
+// background writer.
+class IncumbentStore {
+    public:
+        static IncumbentStore& getInstance();
+        ~IncumbentStore();
+
+        shared_ptr<const Incumbent> get(const string& instance_id);
+        // Returns true when the solution became the incumbent of the instance
+        bool offer(const string& instance_id, double obj_val, const vector<int>& solution, int sense, int job_id);
+        // Blocks until every pending incumbent is written
+        void flush();
+
+        // Worker processes have no database: incumbents come with the jobs and are
+        // installed with set(), and offered solutions are kept in memory only
+        void set(const string& instance_id, shared_ptr<const Incumbent> incumbent);
+        void setPersistent(bool value) { persistent = value; }
+        // get() returns the incumbent loaded at the first lookup instead of the current
+        // best, offers are still recorded and persisted. Used by deterministic runs.
+        void setFrozen(bool value) { frozen = value; }
+
+    private:
+        struct Slot {
+            once_flag loaded;
+            mutex slot_mutex;
+            shared_ptr<const Incumbent> best;
+            shared_ptr<const Incumbent> initial; // best at the first lookup
+        };
+
+        shared_mutex slots_mutex;
+        unordered_map<string, shared_ptr<Slot>> slots;
+
+        mutex writer_mutex;
+        condition_variable writer_cv;
+        condition_variable flushed_cv;
+        unordered_set<string> dirty;
+        bool writing = false;
+        bool stopping = false;
+        atomic<bool> persistent{true};
+        atomic<bool> frozen{false};
+        thread writer;
+
+        shared_ptr<Slot> getSlot(const string& instance_id);
+        void writeLoop();
+};
@@ -0,0 +1,75 @@
+#include "incumbent_timeline.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+const char TIMELINE_MAGIC = 'T';
+const char TIMELINE_VERSION = 1;
+const int TIMELINE_HEADER_BYTES = 2;
+const int TIMELINE_EVENT_BYTES = 4 * sizeof(double);
+
+vector<char> encodeTimeline(const vector<IncumbentEvent>& timeline) {
+    vector<char> blob(TIMELINE_HEADER_BYTES + timeline.size() * TIMELINE_EVENT_BYTES);
+    blob[0] = TIMELINE_MAGIC;
+    blob[1] = TIMELINE_VERSION;
+    char* out = blob.data() + TIMELINE_HEADER_BYTES;
+    for (const IncumbentEvent& event : timeline) {
+        double fields[4] = {event.time_s, event.obj_val, event.bound, event.node_count};
+        memcpy(out, fields, TIMELINE_EVENT_BYTES);
+        out += TIMELINE_EVENT_BYTES;
+    }
+    return blob;
+}
+
+vector<IncumbentEvent> decodeTimeline(const vector<char>& blob) {
+    if (blob.size() < TIMELINE_HEADER_BYTES || blob[0] != TIMELINE_MAGIC || blob[1] != TIMELINE_VERSION) {
+        throw runtime_error("Not an incumbent timeline");
+    }
+    if ((blob.size() - TIMELINE_HEADER_BYTES) % TIMELINE_EVENT_BYTES != 0) {
+        throw runtime_error("Truncated incumbent timeline");
+    }
+    vector<IncumbentEvent> timeline((blob.size() - TIMELINE_HEADER_BYTES) / TIMELINE_EVENT_BYTES);
+    const char* in = blob.data() + TIMELINE_HEADER_BYTES;
+    for (IncumbentEvent& event : timeline) {
+        double fields[4];
+        memcpy(fields, in, TIMELINE_EVENT_BYTES);
+        event = {fields[0], fields[1], fields[2], fields[3]};
+        in += TIMELINE_EVENT_BYTES;
+    }
+    return timeline;
+}
+
+double boundedPrimalGap(double obj_val, double reference) {
+    if (abs(obj_val) < 1e-9 && abs(reference) < 1e-9) {
+        return 0.0;
+    }
+    if (obj_val * reference < 0.0) {
+        return 1.0;
+    }
+    return min(1.0, abs(obj_val - reference) / max(abs(obj_val), abs(reference)));
+}
+
+PrimalMetrics computePrimalMetrics(const vector<IncumbentEvent>& timeline, double end_s, double reference, double target_gap) {
+    PrimalMetrics metrics;
+    if (timeline.empty()) {
+        metrics.primal_integral = end_s;
+        return metrics;
+    }
+    metrics.time_to_first_s = timeline.front().time_s;
+    end_s = max(end_s, timeline.back().time_s);
+
+    double integral = timeline.front().time_s; // gap 1 before the first incumbent
+    for (int i = 0; i < timeline.size(); i++) {
+        double gap = boundedPrimalGap(timeline[i].obj_val, reference);
+        double next_s = i + 1 < timeline.size() ? timeline[i + 1].time_s : end_s;
+        integral += gap * (next_s - timeline[i].time_s);
+        if (metrics.time_to_target_s < 0 && gap <= target_gap) {
+            metrics.time_to_target_s = timeline[i].time_s;
+        }
+    }
+    metrics.primal_integral = integral;
+    return metrics;
+}
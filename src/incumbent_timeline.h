@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+using namespace std;
+
+// One improving incumbent of a job
+struct IncumbentEvent {
+    double time_s;
+    double obj_val;
+    double bound; // best bound when the incumbent was found, infinite if unknown (LNS)
+    double node_count;
+};
+
+// Packed little endian doubles behind a 'T' magic byte and a version byte, 
+// 32 bytes per event. pysolver/set_primal_gap.py reads the same layout.
+vector<char> encodeTimeline(const vector<IncumbentEvent>& timeline);
+// Throws runtime_error on malformed input
+vector<IncumbentEvent> decodeTimeline(const vector<char>& blob);
+
+const double PRIMAL_TARGET_GAP = 0.01;
+
+struct PrimalMetrics {
+    double primal_integral = -1.0;
+    double time_to_first_s = -1.0; // -1 if the job found no solution
+    double time_to_target_s = -1.0; // first incumbent within PRIMAL_TARGET_GAP of the reference
+};
+
+// Primal gap in [0, 1] as defined for the primal integral (Berthold 2013):
+// |obj - reference| / max(|obj|, |reference|), 1 when the signs differ
+double boundedPrimalGap(double obj_val, double reference);
+
+// Integral of the bounded primal gap over [0, end_s], the gap is 1 until the first incumbent
+PrimalMetrics computePrimalMetrics(const vector<IncumbentEvent>& timeline, double end_s, double reference, double target_gap = PRIMAL_TARGET_GAP);
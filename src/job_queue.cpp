@@ -0,0 +1,279 @@
+#include "job_queue.h"
+#include "trace.h"
+#include "fmt/core.h"
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+#include <unistd.h>
+
+using namespace std;
+
+string jobParamsKey(const Job& job) {
+    return fmt::format(
+        "{}|{}|time_limit_s={}|callback={}:{}:{}|warm_start={}|lns={}|seed={}|fixing_ratio={}|iterative={}:{}|"
+        "fixing_method={}|adaptive={}|neighborhood={}|helpers={}|stall={}:{}:{}|stop_at_best_known={}",
+        job.instance_id, job.group_name, job.time_limit_s,
+        job.enable_callback, job.metrics_every_nodes, job.metrics_every_ms,
+        job.warm_start, job.enable_lns, job.seed, job.fixing_ratio, job.iterative_lns, job.sub_mip_time_s,
+        job.fixing_method, job.adaptive_lns, job.neighborhood, job.lns_helpers,
+        job.stall_time_s, job.stall_nodes, job.min_gap_rate, job.stop_at_best_known)
+        // Time jobs keep the keys they had before work limits
+        + (job.limit_type == "time" ? "" : fmt::format("|limit={}:{}", job.limit_type, job.limit_value))
+        + (job.race_id == 0 ? "" : fmt::format("|race={}", job.race_id));
+}
+
+// SQLite caps the parameters of a statement (SQLITE_MAX_VARIABLE_NUMBER, 999 before 3.32),
+// so in() lists are split into batches of this size
+const size_t MAX_IN_PARAMETERS = 500;
+
+template <class T>
+static vector<vector<T>> inBatches(const vector<T>& values) {
+    vector<vector<T>> batches;
+    for (size_t start = 0; start < values.size(); start += MAX_IN_PARAMETERS) {
+        batches.emplace_back(values.begin() + start, values.begin() + min(values.size(), start + MAX_IN_PARAMETERS));
+    }
+    return batches;
+}
+
+void backfillParamsKeys() {
+    lock_guard<mutex> lock(get_db_mutex());
+    auto& storage = get_storage();
+    vector<Job> jobs = storage.get_all<Job>(where(c(&Job::params_key) == ""));
+    storage.transaction([&] {
+        for (Job& job : jobs) {
+            storage.update_all(
+                sqlite_orm::set(c(&Job::params_key) = jobParamsKey(job)),
+                where(c(&Job::id) == job.id)
+            );
+        }
+        return true;
+    });
+    if (!jobs.empty()) {
+        fmt::print("Computed params_key of {} existing jobs\n", jobs.size());
+    }
+}
+
+static string processWorkerId() {
+    char host[256] = "localhost";
+    gethostname(host, sizeof(host) - 1);
+    return fmt::format("{}:{}", host, getpid());
+}
+
+JobQueue::JobQueue(int lease_s, int max_attempts) 
+    : lease_s(max(lease_s, 3)), max_attempts(max(max_attempts, 1)), worker_id(processWorkerId()) {
+    heartbeat_thread = thread(&JobQueue::heartbeat, this);
+}
+
+JobQueue::~JobQueue() {
+    {
+        lock_guard<mutex> lock(active_mutex);
+        stopping = true;
+    }
+    stop_signal.notify_all();
+    heartbeat_thread.join();
+}
+
+vector<int> JobQueue::enqueue(vector<Job>& jobs) {
+    vector<string> keys;
+    for (Job& job : jobs) {
+        job.params_key = jobParamsKey(job);
+        keys.push_back(job.params_key);
+    }
+
+    lock_guard<mutex> lock(get_db_mutex());
+    auto& storage = get_storage();
+    int num_done = 0;
+    queued_ids.clear();
+    requeued_ids.clear();
+    // Immediate so that two processes enqueueing the same campaign do not both insert it
+    storage.begin_immediate_transaction();
+    try {
+        // Earlier runs of the same jobs, a completed one wins over its failed reruns
+        unordered_map<string, pair<int, string>> existing;
+        for (auto& batch : inBatches(keys)) {
+            for (auto& [id, key, status] : storage.select(
+                columns(&Job::id, &Job::params_key, &Job::status),
+                where(in(&Job::params_key, batch))
+            )) {
+                auto it = existing.find(key);
+                if (it == existing.end() || status == "done") {
+                    existing[key] = {id, status};
+                }
+            }
+        }
+
+        for (Job& job : jobs) {
+            auto it = existing.find(job.params_key);
+            if (it == existing.end()) {
+                job.status = "pending";
+                job.id = storage.insert(job);
+                existing[job.params_key] = {job.id, job.status};
+                queued_ids.push_back(job.id);
+                continue;
+            }
+            auto& [id, status] = it->second;
+            job.id = id;
+            if (status == "done") {
+                num_done++;
+                continue;
+            }
+            if (status == "failed") {
+                storage.update_all(sqlite_orm::set(c(&Job::status) = "pending", c(&Job::attempts) = 0), where(c(&Job::id) == id));
+                status = "pending";
+            }
+            queued_ids.push_back(id);
+        }
+        storage.commit();
+    } catch (...) {
+        storage.rollback();
+        throw;
+    }
+
+    // Duplicate jobs in the input map to the same row
+    sort(queued_ids.begin(), queued_ids.end());
+    queued_ids.erase(unique(queued_ids.begin(), queued_ids.end()), queued_ids.end());
+    next_index = 0;
+    fmt::print("Queue: {} jobs, {} already done, {} to run\n", jobs.size(), num_done, queued_ids.size());
+    return queued_ids;
+}
+
+// Moves a pending job, or one whose lease expired with claims left, to running. The
+// condition on the current state makes the update a compare and set between processes.
+bool JobQueue::tryClaim(int job_id) {
+    auto& storage = get_storage();
+    int64_t now = unix_now();
+    storage.update_all(
+        sqlite_orm::set(
+            c(&Job::status) = "running",
+            c(&Job::worker_id) = worker_id,
+            c(&Job::lease_expires_at) = now + lease_s,
+            c(&Job::heartbeat_at) = now,
+            c(&Job::attempts) = c(&Job::attempts) + 1
+        ),
+        where(c(&Job::id) == job_id
+            and (c(&Job::status) == "pending"
+                or (c(&Job::status) == "running" and c(&Job::lease_expires_at) < now and c(&Job::attempts) < max_attempts)))
+    );
+    return storage.changes() == 1;
+}
+
+optional<Job> JobQueue::claim() {
+    TRACE_SPAN("queue_claim");
+    lock_guard<mutex> lock(get_db_mutex());
+    auto& storage = get_storage();
+    optional<int> claimed;
+    while (!claimed && !requeued_ids.empty()) {
+        int job_id = requeued_ids.back();
+        requeued_ids.pop_back();
+        if (tryClaim(job_id)) {
+            claimed = job_id;
+        }
+    }
+    while (!claimed && next_index < queued_ids.size()) {
+        int job_id = queued_ids[next_index++];
+        if (tryClaim(job_id)) {
+            claimed = job_id;
+        }
+    }
+    // Every job was handed out once, pick up the ones whose process died. A job that
+    // keeps killing its process fails after max_attempts instead of taking down every worker
+    vector<vector<int>> batches = claimed ? vector<vector<int>>() : inBatches(queued_ids);
+    for (size_t batch = 0; !claimed && batch < batches.size();) {
+        int64_t now = unix_now();
+        auto expired = storage.select(columns(&Job::id, &Job::attempts),
+            where(in(&Job::id, batches[batch])
+                and c(&Job::status) == "running"
+                and c(&Job::lease_expires_at) < now),
+            limit(1)
+        );
+        if (expired.empty()) {
+            batch++;
+            continue;
+        }
+        auto [job_id, attempts] = expired[0];
+        if (attempts >= max_attempts) {
+            storage.update_all(
+                sqlite_orm::set(c(&Job::status) = "failed", c(&Job::lease_expires_at) = 0),
+                where(c(&Job::id) == job_id and c(&Job::status) == "running" and c(&Job::lease_expires_at) < now)
+            );
+            fmt::print("Job {} failed, its lease expired on all {} attempts\n", job_id, attempts);
+            continue;
+        }
+        if (tryClaim(job_id)) {
+            claimed = job_id;
+            fmt::print("Reclaimed job {} after its lease expired\n", job_id);
+        }
+    }
+    if (!claimed) {
+        return nullopt;
+    }
+
+    {
+        lock_guard<mutex> active_lock(active_mutex);
+        active_ids.insert(*claimed);
+    }
+    return storage.get<Job>(*claimed);
+}
+
+void JobQueue::release(const Job& job) {
+    {
+        lock_guard<mutex> active_lock(active_mutex);
+        active_ids.erase(job.id);
+    }
+    lock_guard<mutex> lock(get_db_mutex());
+    get_storage().update_all(
+        sqlite_orm::set(c(&Job::status) = "failed", c(&Job::lease_expires_at) = 0),
+        where(c(&Job::id) == job.id and c(&Job::status) == "running" and c(&Job::worker_id) == worker_id)
+    );
+}
+
+bool JobQueue::requeue(const Job& job) {
+    {
+        lock_guard<mutex> active_lock(active_mutex);
+        active_ids.erase(job.id);
+    }
+    lock_guard<mutex> lock(get_db_mutex());
+    auto& storage = get_storage();
+    auto attempts = storage.select(&Job::attempts, where(c(&Job::id) == job.id));
+    bool retry = !attempts.empty() && attempts[0] < max_attempts;
+    storage.update_all(
+        sqlite_orm::set(c(&Job::status) = retry ? "pending" : "failed", c(&Job::lease_expires_at) = 0),
+        where(c(&Job::id) == job.id and c(&Job::status) == "running" and c(&Job::worker_id) == worker_id)
+    );
+    if (retry) {
+        requeued_ids.push_back(job.id);
+    }
+    return retry;
+}
+
+int JobQueue::numRemaining() {
+    lock_guard<mutex> lock(get_db_mutex());
+    int remaining = 0;
+    for (auto& batch : inBatches(queued_ids)) {
+        remaining += get_storage().count<Job>(
+            where(in(&Job::id, batch) and (c(&Job::status) == "pending" or c(&Job::status) == "running"))
+        );
+    }
+    return remaining;
+}
+
+// Renews the leases three times per lease period
+void JobQueue::heartbeat() {
+    unique_lock<mutex> active_lock(active_mutex);
+    while (!stop_signal.wait_for(active_lock, chrono::seconds(lease_s) / 3, [&] { return stopping; })) {
+        vector<int> job_ids(active_ids.begin(), active_ids.end());
+        active_lock.unlock();
+        {
+            lock_guard<mutex> lock(get_db_mutex());
+            auto& storage = get_storage();
+            int64_t now = unix_now();
+            for (int job_id : job_ids) {
+                storage.update_all(
+                    sqlite_orm::set(c(&Job::lease_expires_at) = now + lease_s, c(&Job::heartbeat_at) = now),
+                    where(c(&Job::id) == job_id and c(&Job::status) == "running" and c(&Job::worker_id) == worker_id)
+                );
+            }
+        }
+        active_lock.lock();
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "db.h"
+
+using namespace std;
+
+// Identity of a job across runs: instance, every solver parameter and the seed.
+// Fields that do not change the result (id, queue state, created_at, threads) are left out.
+string jobParamsKey(const Job& job);
+
+// Fills params_key of jobs written before the queue, so reruns skip them as well
+void backfillParamsKeys();
+
+// Job queue in the jobs table, shared by every process using the database.
+// Jobs are enqueued as pending before anything runs. A worker claims one by moving it
+// to running under a lease, with a compare and set on the row so two processes never
+// claim the same job. A heartbeat thread renews the leases of the running jobs, and
+// a job whose lease expired (its process died) can be claimed again, up to max_attempts
+// claims in total, after which it is marked failed.
+class JobQueue {
+    public:
+        explicit JobQueue(int lease_s = 60, int max_attempts = 3);
+        ~JobQueue();
+
+        // Writes the jobs that are not in the queue yet and sets job.id of all of them.
+        // Returns the ids still to run: jobs that already completed are skipped and
+        // failed ones are retried with a fresh attempt count.
+        vector<int> enqueue(vector<Job>& jobs);
+        // Next claimable job of the last enqueue, in id order. Requeued jobs come first,
+        // and once every job was handed out, jobs whose lease expired are claimed again.
+        optional<Job> claim();
+        // Ends the lease. A job still running at this point did not write its results
+        // and is marked failed.
+        void release(const Job& job);
+        // Puts a running job back to pending for the next claim, e.g. when the worker
+        // process solving it disconnected. Returns false, and marks the job failed,
+        // after max_attempts claims.
+        bool requeue(const Job& job);
+
+        // Jobs of the last enqueue that are pending or running, in any process
+        int numRemaining();
+
+        const string& workerId() const { return worker_id; }
+
+    private:
+        int lease_s;
+        int max_attempts;
+        string worker_id;
+        vector<int> queued_ids;
+        size_t next_index = 0;
+        vector<int> requeued_ids;
+
+        mutex active_mutex;
+        condition_variable stop_signal;
+        bool stopping = false;
+        std::set<int> active_ids;
+        thread heartbeat_thread;
+
+        bool tryClaim(int job_id);
+        void heartbeat();
+};
@@ -0,0 +1,215 @@
+#include "lns.h"
+#include "utils.h"
+#include "bound_fixer.h"
+#include "adaptive_lns.h"
+#include "model_cache.h"
+#include "neighborhood.h"
+#include "trace.h"
+#include "fmt/core.h"
+#include <chrono>
+#include <memory>
+#include <random>
+
+using namespace std;
+
+GRBConstr addFixingConstraint(GRBModel& model, vector<GRBVar>& binary_variables, const vector<double>& solution, const vector<int>& fixing_indices) {
+    GRBLinExpr lns_expression = 0;
+    for (int var_index : fixing_indices) {
+        GRBVar var = binary_variables[var_index];
+        double value = solution[var_index];
+        lns_expression += var * (1 - value); // if value is 0, we must fix var to 0
+        lns_expression += (1 - var) * value; // if value is 1, we must fix var to 1
+    }
+    return model.addConstr(lns_expression == 0, "LNS");
+}
+
+double jobBudget(const Job& job, double seconds) {
+    if (job.limit_type != "work") {
+        return seconds;
+    }
+    return seconds * job.limit_value / max(job.time_limit_s, 1);
+}
+
+void setJobLimit(GRBModel& model, const Job& job, double budget) {
+    bool by_work = job.limit_type == "work";
+    model.set(GRB_DoubleParam_TimeLimit, by_work ? GRB_INFINITY : budget);
+    model.set(GRB_DoubleParam_WorkLimit, by_work ? budget : GRB_INFINITY);
+}
+
+static bool isImprovement(double candidate, double incumbent, int sense) {
+    double tolerance = 1e-9 * max(1.0, abs(incumbent));
+    if (sense == GRB_MAXIMIZE) {
+        return candidate > incumbent + tolerance;
+    }
+    return candidate < incumbent - tolerance;
+}
+
+LNSResult runIterativeLNS(GRBModel& model, Job& job, vector<GRBVar>& binary_variables, const optional<vector<int>>& start_solution) {
+    LNSResult result;
+    result.status = job.limit_type == "work" ? GRB_WORK_LIMIT : GRB_TIME_LIMIT;
+    int sense = model.get(GRB_IntAttr_ModelSense);
+    result.obj_val = sense == GRB_MAXIMIZE ? -GRB_INFINITY : GRB_INFINITY;
+
+    int num_vars = model.get(GRB_IntAttr_NumVars);
+    unique_ptr<GRBVar[]> vars(model.getVars());
+    int num_binary_variables = binary_variables.size();
+
+    // Incumbent over the binary variables, used to build the neighborhoods
+    vector<double> binary_values(num_binary_variables, 0.0);
+    // Full incumbent, passed back to Gurobi as a MIP start
+    vector<double> incumbent;
+    bool has_binary_values = false;
+    if (start_solution) {
+        binary_values = solution_to_values(*start_solution, num_binary_variables);
+        has_binary_values = true;
+        setAttrArray(model, GRB_DoubleAttr_Start, binary_variables.data(), binary_values);
+    }
+
+    bool use_bounds = job.fixing_method == "bounds";
+    BoundFixer fixer(model, binary_variables);
+
+    optional<AdaptiveLNS> adaptive;
+    if (job.adaptive_lns) {
+        adaptive.emplace(model, binary_variables, job.instance_id, 1.0 - job.fixing_ratio);
+    }
+    optional<NeighborhoodGenerator> generator;
+    if (!adaptive && job.neighborhood != "random") {
+        generator.emplace(ModelCache::getInstance().getVarConstraintIndex(job.instance_id, model, binary_variables));
+    }
+
+    mt19937 rng(job.seed);
+    auto start_time = chrono::steady_clock::now();
+    auto elapsed_s = [&]() {
+        return chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+    };
+
+    // Seconds, or work units charged to the sub-MIPs for work jobs. Every sub-MIP is
+    // charged at least 1% of its budget so that trivial sub-MIPs cannot loop forever
+    bool by_work = job.limit_type == "work";
+    double charged_work = 0.0;
+    auto spent = [&]() {
+        return by_work ? charged_work : elapsed_s();
+    };
+    double budget = jobBudget(job, job.time_limit_s);
+    double sub_mip_budget = jobBudget(job, job.sub_mip_time_s);
+    double stall_budget = jobBudget(job, job.stall_time_s);
+
+    int iteration = 0;
+    double remaining = budget;
+    double improved_at = 0.0;
+    while (remaining > 0.001 * budget) {
+        setJobLimit(model, job, min(sub_mip_budget, remaining));
+
+        // Without an incumbent the first sub-MIP is the full problem
+        Neighborhood neighborhood;
+        optional<GRBConstr> fixing_constraint;
+        bool destroyed = has_binary_values;
+        auto fixing_start = chrono::steady_clock::now();
+        if (destroyed) {
+            TRACE_SPAN("lns_destroy");
+            if (adaptive) {
+                neighborhood = adaptive->next(binary_values, rng);
+            } else if (generator) {
+                int num_free = num_binary_variables - (int)(num_binary_variables * job.fixing_ratio);
+                neighborhood.fixing_indices = generator->generate(job.neighborhood, num_free, rng);
+            } else {
+                neighborhood.fixing_indices = sample_percentage(num_binary_variables, job.fixing_ratio, rng);
+            }
+            vector<int>& fixing_indices = neighborhood.fixing_indices;
+            if (neighborhood.local_branching_k >= 0) {
+                fixing_constraint = addLocalBranchingConstraint(model, binary_variables, binary_values, neighborhood.local_branching_k);
+            } else if (use_bounds) {
+                fixer.fix(fixing_indices, binary_values);
+            } else {
+                fixing_constraint = addFixingConstraint(model, binary_variables, binary_values, fixing_indices);
+            }
+        }
+        double fixing_time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - fixing_start).count();
+        if (!incumbent.empty()) {
+            model.set(GRB_DoubleAttr_Start, vars.get(), incumbent.data(), num_vars);
+        }
+
+        {
+            TRACE_SPAN("sub_mip");
+            model.optimize();
+        }
+
+        int num_fixed = neighborhood.fixing_indices.size();
+        LNSIteration record = {
+            .iteration = iteration,
+            .neighborhood_size = neighborhood.local_branching_k >= 0 ? neighborhood.local_branching_k : num_binary_variables - num_fixed,
+            .num_fixed = num_fixed,
+            .sub_mip_time_s = model.get(GRB_DoubleAttr_Runtime),
+            .status = model.get(GRB_IntAttr_Status),
+            .fixing_time_ms = fixing_time_ms,
+            .operator_name = adaptive ? operatorName(neighborhood.op) : job.neighborhood,
+        };
+        result.node_count += model.get(GRB_DoubleAttr_NodeCount);
+        // The RINS LP relaxation is solved during the destroy step and charged to the iteration
+        record.work = model.get(GRB_DoubleAttr_Work) + (adaptive ? adaptive->takeLPWork() : 0.0);
+        result.work += record.work;
+        charged_work += max(record.work, 0.01 * sub_mip_budget);
+        result.iter_count += model.get(GRB_DoubleAttr_IterCount);
+        result.bar_iter_count += model.get(GRB_IntAttr_BarIterCount);
+
+        double gain = 0.0;
+        if (model.get(GRB_IntAttr_SolCount) > 0) {
+            double obj_val = model.get(GRB_DoubleAttr_ObjVal);
+            record.obj_val = obj_val;
+            if (!result.has_solution || isImprovement(obj_val, result.obj_val, sense)) {
+                gain = result.has_solution ? abs(obj_val - result.obj_val) : 0.0;
+                result.obj_val = obj_val;
+                result.has_solution = true;
+                record.improved = true;
+
+                unique_ptr<double[]> x(model.get(GRB_DoubleAttr_X, vars.get(), num_vars));
+                incumbent.assign(x.get(), x.get() + num_vars);
+                vector<double> x_binary = getAttrArray(model, GRB_DoubleAttr_X, binary_variables.data(), num_binary_variables);
+                for (int i = 0; i < num_binary_variables; i++) {
+                    binary_values[i] = x_binary[i] > 0.5 ? 1.0 : 0.0;
+                }
+                has_binary_values = true;
+            }
+        }
+
+        {
+            TRACE_SPAN("lns_restore");
+            if (fixing_constraint) {
+                model.remove(*fixing_constraint);
+            }
+            fixer.restore();
+        }
+        // The first solution of a job has no previous objective and counts as no gain
+        if (adaptive && destroyed) {
+            adaptive->update(neighborhood, record.status, gain > 0.0, gain, record.sub_mip_time_s);
+        }
+
+        record.best_obj_val = result.obj_val;
+        record.elapsed_ms = (int64_t)(elapsed_s() * 1000);
+        result.iterations.push_back(record);
+        fmt::print("LNS iteration {} ({}): {} free, obj {}, best {}{}\n", 
+            iteration, record.operator_name, record.neighborhood_size, record.obj_val, result.obj_val, record.improved ? " (improved)" : "");
+
+        iteration++;
+        remaining = budget - spent();
+        if (record.improved) {
+            improved_at = spent();
+        }
+        if (job.stall_time_s > 0 && result.has_solution && spent() - improved_at >= stall_budget) {
+            result.termination_reason = "stall_time";
+            break;
+        }
+    }
+
+    setJobLimit(model, job, budget);
+    result.runtime_s = elapsed_s();
+    if (adaptive) {
+        result.operator_stats = adaptive->getStats();
+    }
+    for (int i = 0; i < num_binary_variables && result.has_solution; i++) {
+        if (binary_values[i] > 0.5) {
+            result.best_solution.push_back(i);
+        }
+    }
+    return result;
+}
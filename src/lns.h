@@ -0,0 +1,45 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "db.h"
+#include "gurobi_c++.h"
+
+using namespace std;
+
+struct LNSResult {
+    vector<LNSIteration> iterations;
+    vector<int> best_solution; // indices of the non zero binary variables
+    double obj_val = GRB_INFINITY;
+    bool has_solution = false;
+    double runtime_s = 0.0;
+    double node_count = 0.0;
+    // Summed over the sub-MIPs
+    double work = 0.0;
+    double iter_count = 0.0;
+    int bar_iter_count = 0;
+    vector<LNSOperatorStats> operator_stats; // adaptive LNS only
+    string termination_reason = "none";
+    int status = GRB_TIME_LIMIT; // GRB_WORK_LIMIT for work jobs
+};
+
+// Durations of a job in the unit of its limit: seconds for time jobs, Gurobi work
+// units for work jobs, scaled by limit_value / time_limit_s. A work job with
+// time_limit_s = 10 and sub_mip_time_s = 1 runs its sub-MIPs for a tenth of limit_value.
+double jobBudget(const Job& job, double seconds);
+// Sets the time or work limit of the next optimize() of the job's model
+void setJobLimit(GRBModel& model, const Job& job, double budget);
+
+// Adds a single constraint fixing the binary variables at fixing_indices to their value in solution
+GRBConstr addFixingConstraint(GRBModel& model, vector<GRBVar>& binary_variables, const vector<double>& solution, const vector<int>& fixing_indices);
+
+// Destroy and repair loop over the same model. Every iteration fixes job.fixing_ratio of the 
+// binary variables to the incumbent and solves the sub-MIP for at most job.sub_mip_time_s 
+// until job.time_limit_s is spent, both in work units for work jobs (see jobBudget). start_solution seeds the incumbent (non zero binary indices).
+// job.fixing_method selects between bound fixing ("bounds") and a fixing row ("constraint").
+// With job.adaptive_lns the destroy operator and the neighborhood size are chosen online
+// by AdaptiveLNS, starting from 1 - job.fixing_ratio free variables. Otherwise job.neighborhood
+// selects uniform random fixing or a constraint graph neighborhood from neighborhood.h.
+// job.stall_time_s ends the loop early when the incumbent has not improved for that long.
+LNSResult runIterativeLNS(GRBModel& model, Job& job, vector<GRBVar>& binary_variables, const optional<vector<int>>& start_solution);
@@ -14,7 +14,14 @@ inline string getMpsDir() {
     return string(mps_files_dir);
 }
 
+inline string getMpsPath(const string& instance_name) {
+    return fmt::format("{}/{}.mps", getMpsDir(), instance_name);
+}
+
+inline GRBModel loadModel(const string& instance_name, GRBEnv& env) {
+    return GRBModel(env, getMpsPath(instance_name));
+}
+
 inline GRBModel loadModel(const string& instance_name) {
-    string path = fmt::format("{}/{}.mps", getMpsDir(), instance_name); 
-    return GRBModel(GurobiEnvironment::getEnv(), path);
+    return loadModel(instance_name, GurobiEnvironment::getEnv());
 }
@@ -0,0 +1,81 @@
+#include "metrics_collector.h"
+#include "trace.h"
+#include "fmt/core.h"
+#include <chrono>
+
+using namespace std;
+
+static size_t nextPowerOfTwo(size_t value) {
+    size_t power = 1;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+}
+
+MetricsCollector::MetricsCollector(int job_id, ResultSink& sink, size_t capacity, int drain_interval_ms) 
+    : job_id(job_id), sink(sink), buffer(nextPowerOfTwo(capacity)), mask(buffer.size() - 1), drain_interval_ms(drain_interval_ms) {
+    drainer = thread(&MetricsCollector::drainLoop, this);
+}
+
+MetricsCollector::~MetricsCollector() {
+    stop();
+}
+
+bool MetricsCollector::push(const CallbackMetric& metric) {
+    size_t write_index = head.load(memory_order_relaxed);
+    if (write_index - tail.load(memory_order_acquire) >= buffer.size()) {
+        dropped.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    buffer[write_index & mask] = metric;
+    head.store(write_index + 1, memory_order_release);
+    return true;
+}
+
+void MetricsCollector::drain(vector<CallbackMetric>& batch) {
+    batch.clear();
+    size_t read_index = tail.load(memory_order_relaxed);
+    size_t write_index = head.load(memory_order_acquire);
+    for (; read_index != write_index; read_index++) {
+        batch.push_back(buffer[read_index & mask]);
+        batch.back().job_id = job_id;
+    }
+    tail.store(read_index, memory_order_release);
+
+    if (!batch.empty()) {
+        TRACE_SPAN("write_metrics");
+        try {
+            sink.writeMetrics(batch);
+            written += batch.size();
+        } catch (exception& e) {
+            fmt::print("Error writing callback metrics of job {}: {}\n", job_id, e.what());
+        }
+    }
+}
+
+void MetricsCollector::drainLoop() {
+    TRACE_THREAD(job_id);
+    vector<CallbackMetric> batch;
+    batch.reserve(buffer.size());
+    unique_lock<mutex> lock(stop_mutex);
+    while (!stopping) {
+        stop_cv.wait_for(lock, chrono::milliseconds(drain_interval_ms));
+        lock.unlock();
+        drain(batch);
+        lock.lock();
+    }
+    lock.unlock();
+    drain(batch);
+}
+
+void MetricsCollector::stop() {
+    {
+        lock_guard<mutex> lock(stop_mutex);
+        stopping = true;
+    }
+    stop_cv.notify_all();
+    if (drainer.joinable()) {
+        drainer.join();
+    }
+}
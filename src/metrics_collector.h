@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "db.h"
+#include "result_sink.h"
+
+using namespace std;
+
+// Fixed capacity ring buffer between the Gurobi callback (single producer) and
+// a background thread (single consumer) writing the metrics of one job to 
+// callback_metrics through the job's ResultSink. push() never allocates or blocks, metrics are dropped and 
+// counted when the drain thread falls behind.
+class MetricsCollector {
+    public:
+        MetricsCollector(int job_id, ResultSink& sink, size_t capacity = 1 << 14, int drain_interval_ms = 200);
+        ~MetricsCollector();
+
+        bool push(const CallbackMetric& metric);
+        // Drains what is left and stops the background thread
+        void stop();
+
+        int64_t getWritten() const { return written; }
+        int64_t getDropped() const { return dropped.load(memory_order_relaxed); }
+
+    private:
+        int job_id;
+        ResultSink& sink;
+        vector<CallbackMetric> buffer;
+        size_t mask;
+        atomic<size_t> head{0}; // next slot written by the producer
+        atomic<size_t> tail{0}; // next slot read by the consumer
+        atomic<int64_t> dropped{0};
+        int64_t written = 0;
+
+        int drain_interval_ms;
+        mutex stop_mutex;
+        condition_variable stop_cv;
+        bool stopping = false;
+        thread drainer;
+
+        void drainLoop();
+        void drain(vector<CallbackMetric>& batch);
+};
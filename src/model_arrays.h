@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "gurobi_c++.h"
+#include "trace.h"
+
+using namespace std;
+
+// Whole-array attribute access. Every GRBVar::get/set is a separate library call,
+// the array overloads of GRBModel::get/set read or write all variables in one call.
+inline vector<double> getAttrArray(GRBModel& model, GRB_DoubleAttr attr, const GRBVar* vars, int num_vars) {
+    if (num_vars == 0) {
+        return {};
+    }
+    unique_ptr<double[]> values(model.get(attr, vars, num_vars));
+    return vector<double>(values.get(), values.get() + num_vars);
+}
+
+inline vector<char> getAttrArray(GRBModel& model, GRB_CharAttr attr, const GRBVar* vars, int num_vars) {
+    if (num_vars == 0) {
+        return {};
+    }
+    unique_ptr<char[]> values(model.get(attr, vars, num_vars));
+    return vector<char>(values.get(), values.get() + num_vars);
+}
+
+inline void setAttrArray(GRBModel& model, GRB_DoubleAttr attr, const GRBVar* vars, const vector<double>& values) {
+    if (values.empty()) {
+        return;
+    }
+    model.set(attr, vars, values.data(), values.size());
+}
+
+inline bool isBinary(char vtype, double lb, double ub) {
+    return vtype == 'B' || (vtype == 'I' && lb == 0.0 && ub == 1.0);
+}
+
+// Variable array and binary index mask of a model, read once with three bulk calls
+struct ModelArrays {
+    unique_ptr<GRBVar[]> vars;
+    int num_vars = 0;
+    vector<char> binary_mask;  // binary_mask[j] != 0 if variable j is binary
+    vector<int> binary_indices; // model index of every binary variable
+    vector<GRBVar> binary_vars;
+
+    explicit ModelArrays(GRBModel& model) {
+        TRACE_SPAN("model_arrays");
+        num_vars = model.get(GRB_IntAttr_NumVars);
+        vars.reset(model.getVars());
+        vector<char> vtypes = getAttrArray(model, GRB_CharAttr_VType, vars.get(), num_vars);
+        vector<double> lbs = getAttrArray(model, GRB_DoubleAttr_LB, vars.get(), num_vars);
+        vector<double> ubs = getAttrArray(model, GRB_DoubleAttr_UB, vars.get(), num_vars);
+
+        binary_mask.resize(num_vars);
+        for (int j = 0; j < num_vars; j++) {
+            binary_mask[j] = isBinary(vtypes[j], lbs[j], ubs[j]);
+            if (binary_mask[j]) {
+                binary_indices.push_back(j);
+                binary_vars.push_back(vars[j]);
+            }
+        }
+    }
+};
@@ -0,0 +1,151 @@
+#include "model_cache.h"
+#include "db.h"
+#include "grb_env.h"
+#include "load_model.h"
+#include "trace.h"
+#include "fmt/core.h"
+#include <algorithm>
+#include <optional>
+
+using namespace std;
+
+size_t estimateModelBytes(GRBModel& model) {
+    size_t nnz = model.get(GRB_IntAttr_NumNZs);
+    size_t num_vars = model.get(GRB_IntAttr_NumVars);
+    size_t num_constrs = model.get(GRB_IntAttr_NumConstrs);
+    // Matrix stored by rows and columns (index + value), plus bounds, types and names
+    return 24 * nnz + 64 * (num_vars + num_constrs);
+}
+
+ModelCache& ModelCache::getInstance() {
+    static ModelCache cache;
+    return cache;
+}
+
+void ModelCache::setContentHash(const string& instance_name, const string& content_hash) {
+    lock_guard<mutex> lock(cache_mutex);
+    content_hashes[instance_name] = content_hash;
+}
+
+void ModelCache::setCapacityMB(size_t capacity_mb) {
+    lock_guard<mutex> lock(cache_mutex);
+    capacity_bytes = capacity_mb * 1024 * 1024;
+    evict("");
+}
+
+void ModelCache::touch(const string& instance_name) {
+    lru.remove(instance_name);
+    lru.push_front(instance_name);
+}
+
+void ModelCache::evict(const string& keep) {
+    auto it = lru.end();
+    while (used_bytes > capacity_bytes && it != lru.begin()) {
+        --it;
+        if (*it == keep) {
+            continue;
+        }
+        auto entry = entries.find(*it);
+        if (entry != entries.end()) {
+            // Jobs copying from this entry keep it alive through their shared_ptr
+            used_bytes -= entry->second->size_bytes;
+            fmt::print("Evicting {} from the model cache\n", *it);
+            entries.erase(entry);
+        }
+        it = lru.erase(it);
+    }
+}
+
+// Entry of the instance, replaced by an empty one when the MPS file was re-seeded with
+// other content. Returns nullptr when the cache is disabled.
+shared_ptr<ModelCache::Entry> ModelCache::getEntry(const string& instance_name) {
+    optional<string> content_hash;
+    {
+        lock_guard<mutex> lock(cache_mutex);
+        if (capacity_bytes == 0) {
+            return nullptr;
+        }
+        auto known = content_hashes.find(instance_name);
+        if (known != content_hashes.end()) {
+            content_hash = known->second;
+        }
+    }
+    if (!content_hash) {
+        content_hash = get_content_hash(instance_name);
+    }
+
+    lock_guard<mutex> lock(cache_mutex);
+    auto& slot = entries[instance_name];
+    if (slot && slot->content_hash != *content_hash) {
+        fmt::print("{} changed on disk, dropping it from the model cache\n", instance_name);
+        used_bytes -= slot->size_bytes;
+        slot = nullptr;
+    }
+    if (!slot) {
+        slot = make_shared<Entry>();
+        slot->content_hash = *content_hash;
+    }
+    touch(instance_name);
+    return slot;
+}
+
+unique_ptr<GRBModel> ModelCache::getModel(const string& instance_name, GRBEnv& env) {
+    TRACE_SPAN("get_model");
+    shared_ptr<Entry> entry = getEntry(instance_name);
+    if (!entry) {
+        TRACE_SPAN("read_mps");
+        return make_unique<GRBModel>(env, getMpsPath(instance_name));
+    }
+
+    // Loading happens outside the cache lock so that workers on other instances 
+    // are not blocked, while workers on the same instance wait for the first parse
+    lock_guard<mutex> entry_lock(entry->entry_mutex);
+    if (!entry->model) {
+        TRACE_SPAN("read_mps");
+        entry->env = GurobiEnvironment::createEnv(0, false);
+        entry->model = make_unique<GRBModel>(*entry->env, getMpsPath(instance_name));
+        size_t model_bytes = estimateModelBytes(*entry->model);
+
+        lock_guard<mutex> lock(cache_mutex);
+        auto slot = entries.find(instance_name);
+        if (slot == entries.end() || slot->second != entry) {
+            // Evicted while loading, this copy is the last use of the model
+            return make_unique<GRBModel>(*entry->model, env);
+        }
+        entry->size_bytes += model_bytes;
+        used_bytes += model_bytes;
+        fmt::print("Cached model {} ({:.1f} MB, {:.1f} MB used)\n", 
+            instance_name, model_bytes / 1e6, used_bytes / 1e6);
+        evict(instance_name);
+    }
+
+    TRACE_SPAN("copy_model");
+    auto model = make_unique<GRBModel>(*entry->model, env);
+    // The copy keeps the parameters of the cached model, use the worker settings instead
+    model->set(GRB_IntParam_OutputFlag, env.get(GRB_IntParam_OutputFlag));
+    model->set(GRB_IntParam_Threads, env.get(GRB_IntParam_Threads));
+    return model;
+}
+
+shared_ptr<const VarConstraintIndex> ModelCache::getVarConstraintIndex(const string& instance_name, GRBModel& model, vector<GRBVar>& binary_variables) {
+    shared_ptr<Entry> entry = getEntry(instance_name);
+    if (!entry) {
+        return buildVarConstraintIndex(instance_name, model, binary_variables);
+    }
+
+    // Jobs on the same instance wait for the first build, copies of the model are not blocked
+    lock_guard<mutex> index_lock(entry->index_mutex);
+    if (!entry->var_index) {
+        shared_ptr<const VarConstraintIndex> index = buildVarConstraintIndex(instance_name, model, binary_variables);
+        lock_guard<mutex> lock(cache_mutex);
+        auto slot = entries.find(instance_name);
+        if (slot == entries.end() || slot->second != entry) {
+            return index;
+        }
+        entry->var_index = index;
+        entry->size_bytes += index->sizeBytes();
+        used_bytes += index->sizeBytes();
+        evict(instance_name);
+    }
+    return entry->var_index;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "gurobi_c++.h"
+#include "neighborhood.h"
+
+using namespace std;
+
+// Process wide cache of parsed MPS files. Every instance is read once and jobs
+// receive a private copy in their own environment, which is much cheaper than
+// parsing the file again. The variable-constraint index of an instance is cached
+// next to its model. The least recently used entries are evicted once the
+// estimated memory of the cached models and indexes exceeds the capacity. An entry
+// is dropped as well when the content hash of its MPS file changed: the one given to
+// setContentHash, or else the one in instance_files.
+class ModelCache {
+    public:
+        static ModelCache& getInstance();
+
+        unique_ptr<GRBModel> getModel(const string& instance_name, GRBEnv& env);
+        // Built on first use from a model of the instance, see buildVarConstraintIndex
+        shared_ptr<const VarConstraintIndex> getVarConstraintIndex(const string& instance_name, GRBModel& model, vector<GRBVar>& binary_variables);
+        void setCapacityMB(size_t capacity_mb);
+        // Worker processes have no database, the coordinator sends the hash with each job
+        void setContentHash(const string& instance_name, const string& content_hash);
+
+    private:
+        struct Entry {
+            mutex entry_mutex;
+            // The cached model owns its environment so that copies can be made 
+            // while the worker that loaded it has moved on
+            unique_ptr<GRBEnv> env;
+            unique_ptr<GRBModel> model;
+            size_t size_bytes = 0;
+            string content_hash;
+            mutex index_mutex;
+            shared_ptr<const VarConstraintIndex> var_index;
+        };
+
+        mutex cache_mutex;
+        unordered_map<string, shared_ptr<Entry>> entries;
+        unordered_map<string, string> content_hashes;
+        list<string> lru; // most recently used first
+        size_t used_bytes = 0;
+        size_t capacity_bytes = 4096ull * 1024 * 1024;
+
+        shared_ptr<Entry> getEntry(const string& instance_name);
+        void touch(const string& instance_name);
+        void evict(const string& keep);
+};
+
+// Rough in-memory footprint of a Gurobi model
+size_t estimateModelBytes(GRBModel& model);
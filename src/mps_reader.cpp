@@ -0,0 +1,513 @@
+#include "mps_reader.h"
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+class MappedFile {
+    public:
+        explicit MappedFile(const string& path) {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw runtime_error("Cannot open " + path);
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                close(fd);
+                throw runtime_error("Cannot stat " + path);
+            }
+            size = st.st_size;
+            if (size > 0) {
+                void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped == MAP_FAILED) {
+                    close(fd);
+                    throw runtime_error("Cannot map " + path);
+                }
+                madvise(mapped, size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(mapped);
+            }
+            close(fd);
+        }
+
+        ~MappedFile() {
+            if (data != nullptr) {
+                munmap(const_cast<char*>(data), size);
+            }
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data = nullptr;
+        size_t size = 0;
+};
+
+enum class Section { None, Name, ObjSense, Rows, Columns, Rhs, Ranges, Bounds, Ignored };
+
+const int MAX_TOKENS = 8;
+
+struct Line {
+    string_view tokens[MAX_TOKENS];
+    int count = 0;
+    bool header = false; // section headers start in the first column
+};
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline Line tokenize(const char* begin, const char* end) {
+    Line line;
+    line.header = begin < end && !isSpace(*begin);
+    const char* p = begin;
+    while (p < end && line.count < MAX_TOKENS) {
+        while (p < end && isSpace(*p)) {
+            p++;
+        }
+        const char* start = p;
+        while (p < end && !isSpace(*p)) {
+            p++;
+        }
+        if (p > start) {
+            line.tokens[line.count++] = string_view(start, p - start);
+        }
+    }
+    return line;
+}
+
+inline double parseDouble(string_view token) {
+    // Tokens point into the mapped file and are not null terminated
+    char buffer[64];
+    if (token.size() >= sizeof(buffer)) {
+        throw runtime_error("Invalid number in MPS file: " + string(token));
+    }
+    memcpy(buffer, token.data(), token.size());
+    buffer[token.size()] = '\0';
+    char* end;
+    double value = strtod(buffer, &end);
+    if (end != buffer + token.size()) {
+        throw runtime_error("Invalid number in MPS file: " + string(token));
+    }
+    if (value >= MPS_INFINITY) {
+        return MPS_INFINITY;
+    }
+    if (value <= -MPS_INFINITY) {
+        return -MPS_INFINITY;
+    }
+    return value;
+}
+
+Section parseSection(string_view keyword) {
+    if (keyword == "NAME") return Section::Name;
+    if (keyword == "OBJSENSE") return Section::ObjSense;
+    if (keyword == "ROWS") return Section::Rows;
+    if (keyword == "COLUMNS") return Section::Columns;
+    if (keyword == "RHS") return Section::Rhs;
+    if (keyword == "RANGES") return Section::Ranges;
+    if (keyword == "BOUNDS") return Section::Bounds;
+    return Section::Ignored; // SOS, QUADOBJ, ... are not needed for the counts
+}
+
+// Open addressing map from names in the mapped file to row or column ids.
+// Names are looked up for every nonzero, a node based map spends most of the 
+// parse in cache misses.
+class NameIndex {
+    public:
+        void insert(string_view name, int id) {
+            if ((size + 1) * 2 > slots.size()) {
+                grow();
+            }
+            place(name, hashName(name), id);
+            size++;
+        }
+
+        int find(string_view name) const {
+            if (slots.empty()) {
+                return -1;
+            }
+            uint64_t hash = hashName(name);
+            size_t mask = slots.size() - 1;
+            for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+                const Slot& slot = slots[i];
+                if (slot.id < 0) {
+                    return -1;
+                }
+                if (slot.hash == hash && slot.name == name) {
+                    return slot.id;
+                }
+            }
+        }
+
+    private:
+        struct Slot {
+            uint64_t hash = 0;
+            string_view name;
+            int id = -1;
+        };
+        vector<Slot> slots;
+        size_t size = 0;
+
+        static uint64_t hashName(string_view name) {
+            // FNV-1a
+            uint64_t hash = 14695981039346656037ull;
+            for (char c : name) {
+                hash ^= (uint8_t)c;
+                hash *= 1099511628211ull;
+            }
+            return hash ^ (hash >> 29);
+        }
+
+        void place(string_view name, uint64_t hash, int id) {
+            size_t mask = slots.size() - 1;
+            size_t i = hash & mask;
+            while (slots[i].id >= 0) {
+                if (slots[i].hash == hash && slots[i].name == name) {
+                    return; // keep the first definition
+                }
+                i = (i + 1) & mask;
+            }
+            slots[i] = {hash, name, id};
+        }
+
+        void grow() {
+            vector<Slot> old = std::move(slots);
+            slots.assign(max<size_t>(1024, old.size() * 2), Slot());
+            for (const Slot& slot : old) {
+                if (slot.id >= 0) {
+                    place(slot.name, slot.hash, slot.id);
+                }
+            }
+        }
+};
+
+struct Triplet {
+    int row;
+    int col;
+    double value;
+};
+
+class MpsParser {
+    public:
+        MpsParser(const MpsReaderOptions& options) : options(options) {}
+
+        MpsModel parse(const char* data, size_t size) {
+            const char* p = data;
+            const char* end = data + size;
+            while (p < end) {
+                const char* line_end = static_cast<const char*>(memchr(p, '\n', end - p));
+                if (line_end == nullptr) {
+                    line_end = end;
+                }
+                if (p < line_end && *p != '*') {
+                    Line line = tokenize(p, line_end);
+                    if (line.count > 0 && !parseLine(line)) {
+                        break;
+                    }
+                }
+                p = line_end + 1;
+            }
+            buildRows();
+            return std::move(model);
+        }
+
+    private:
+        const MpsReaderOptions& options;
+        MpsModel model;
+        Section section = Section::None;
+        bool in_integer_marker = false;
+        string_view objective_row;
+        NameIndex row_index;
+        NameIndex col_index;
+        string_view current_col;
+        int current_col_id = -1;
+        vector<bool> lb_set;
+        vector<Triplet> triplets;
+
+        // Returns false at ENDATA
+        bool parseLine(const Line& line) {
+            if (line.header) {
+                string_view keyword = line.tokens[0];
+                if (keyword == "ENDATA") {
+                    return false;
+                }
+                section = parseSection(keyword);
+                if (section == Section::Name && line.count > 1) {
+                    model.name = string(line.tokens[1]);
+                }
+                if (section == Section::ObjSense && line.count > 1) {
+                    parseObjSense(line.tokens[1]);
+                }
+                return true;
+            }
+
+            switch (section) {
+                case Section::ObjSense: parseObjSense(line.tokens[0]); break;
+                case Section::Rows: parseRow(line); break;
+                case Section::Columns: parseColumn(line); break;
+                case Section::Rhs: parseRhs(line, false); break;
+                case Section::Ranges: parseRhs(line, true); break;
+                case Section::Bounds: parseBound(line); break;
+                default: break;
+            }
+            return true;
+        }
+
+        void parseObjSense(string_view token) {
+            if (token == "MAX" || token == "MAXIMIZE") {
+                model.sense = -1;
+            } else if (token == "MIN" || token == "MINIMIZE") {
+                model.sense = 1;
+            }
+        }
+
+        void parseRow(const Line& line) {
+            if (line.count < 2) {
+                throw runtime_error("Invalid ROWS entry");
+            }
+            char type = line.tokens[0][0];
+            string_view name = line.tokens[1];
+            if (type == 'N') {
+                // The first free row is the objective, later ones are dropped
+                if (objective_row.empty()) {
+                    objective_row = name;
+                }
+                return;
+            }
+            if (type != 'L' && type != 'G' && type != 'E') {
+                throw runtime_error("Invalid row type " + string(line.tokens[0]));
+            }
+            row_index.insert(name, model.row_types.size());
+            model.row_types.push_back(type);
+            if (options.keep_names) {
+                model.row_names.emplace_back(name);
+            }
+        }
+
+        void addColumn(string_view name) {
+            current_col = name;
+            current_col_id = model.col_types.size();
+            col_index.insert(name, current_col_id);
+            model.col_types.push_back(in_integer_marker ? 'I' : 'C');
+            model.obj.push_back(0.0);
+            model.lb.push_back(0.0);
+            model.ub.push_back(in_integer_marker ? options.integer_marker_ub : MPS_INFINITY);
+            lb_set.push_back(false);
+            if (options.keep_names) {
+                model.col_names.emplace_back(name);
+            }
+        }
+
+        void addEntry(string_view row, string_view value) {
+            double coefficient = parseDouble(value);
+            if (row == objective_row) {
+                model.obj[current_col_id] = coefficient;
+                return;
+            }
+            int row_id = row_index.find(row);
+            if (row_id < 0) {
+                // Coefficients in dropped free rows are ignored
+                return;
+            }
+            if (coefficient != 0.0) {
+                triplets.push_back({row_id, current_col_id, coefficient});
+            }
+        }
+
+        void parseColumn(const Line& line) {
+            if (line.count >= 3 && line.tokens[1] == "'MARKER'") {
+                if (line.tokens[2] == "'INTORG'") {
+                    in_integer_marker = true;
+                } else if (line.tokens[2] == "'INTEND'") {
+                    in_integer_marker = false;
+                }
+                return;
+            }
+            if (line.count < 3) {
+                throw runtime_error("Invalid COLUMNS entry");
+            }
+            if (line.tokens[0] != current_col || current_col_id < 0) {
+                addColumn(line.tokens[0]);
+            }
+            addEntry(line.tokens[1], line.tokens[2]);
+            if (line.count >= 5) {
+                addEntry(line.tokens[3], line.tokens[4]);
+            }
+        }
+
+        void setRowValue(string_view row, string_view value, bool is_range) {
+            if (!is_range && row == objective_row) {
+                model.obj_constant = -parseDouble(value);
+                return;
+            }
+            int row_id = row_index.find(row);
+            if (row_id < 0) {
+                return;
+            }
+            if (is_range) {
+                model.ranges[row_id] = parseDouble(value);
+            } else {
+                model.rhs[row_id] = parseDouble(value);
+            }
+        }
+
+        void parseRhs(const Line& line, bool is_range) {
+            if (model.rhs.empty()) {
+                model.rhs.assign(model.row_types.size(), 0.0);
+                model.ranges.assign(model.row_types.size(), 0.0);
+            }
+            // The set name is optional: pairs start at 1 with it and at 0 without
+            int first = line.count % 2 == 1 ? 1 : 0;
+            for (int i = first; i + 1 < line.count; i += 2) {
+                setRowValue(line.tokens[i], line.tokens[i + 1], is_range);
+            }
+        }
+
+        void parseBound(const Line& line) {
+            string_view type = line.tokens[0];
+            bool has_value = !(type == "FR" || type == "MI" || type == "PL" || type == "BV");
+            // type [set] column [value]
+            int col_token = has_value ? line.count - 2 : line.count - 1;
+            if (col_token < 1) {
+                throw runtime_error("Invalid BOUNDS entry");
+            }
+            int col = col_index.find(line.tokens[col_token]);
+            if (col < 0) {
+                throw runtime_error("Unknown column in BOUNDS: " + string(line.tokens[col_token]));
+            }
+            double value = has_value ? parseDouble(line.tokens[col_token + 1]) : 0.0;
+
+            if (type == "UP") {
+                model.ub[col] = value;
+                // MPS convention: a negative upper bound without lower bound frees the lower bound
+                if (value < 0 && !lb_set[col] && model.lb[col] == 0.0) {
+                    model.lb[col] = -MPS_INFINITY;
+                }
+            } else if (type == "LO") {
+                model.lb[col] = value;
+                lb_set[col] = true;
+            } else if (type == "FX") {
+                model.lb[col] = value;
+                model.ub[col] = value;
+                lb_set[col] = true;
+            } else if (type == "FR") {
+                model.lb[col] = -MPS_INFINITY;
+                model.ub[col] = MPS_INFINITY;
+            } else if (type == "MI") {
+                model.lb[col] = -MPS_INFINITY;
+                lb_set[col] = true;
+            } else if (type == "PL") {
+                model.ub[col] = MPS_INFINITY;
+            } else if (type == "BV") {
+                model.col_types[col] = 'B';
+                model.lb[col] = 0.0;
+                model.ub[col] = 1.0;
+            } else if (type == "LI") {
+                model.col_types[col] = 'I';
+                model.lb[col] = value;
+                lb_set[col] = true;
+            } else if (type == "UI") {
+                model.col_types[col] = 'I';
+                model.ub[col] = value;
+                if (value < 0 && !lb_set[col] && model.lb[col] == 0.0) {
+                    model.lb[col] = -MPS_INFINITY;
+                }
+            } else if (type == "SC") {
+                model.col_types[col] = 'S';
+                model.ub[col] = value;
+            } else {
+                throw runtime_error("Invalid bound type " + string(type));
+            }
+        }
+
+        // Counting sort of the column-major entries into rows
+        void buildRows() {
+            int num_rows = model.row_types.size();
+            if (model.rhs.empty()) {
+                model.rhs.assign(num_rows, 0.0);
+                model.ranges.assign(num_rows, 0.0);
+            }
+            model.row_start.assign(num_rows + 1, 0);
+            for (const Triplet& t : triplets) {
+                model.row_start[t.row + 1]++;
+            }
+            for (int i = 0; i < num_rows; i++) {
+                model.row_start[i + 1] += model.row_start[i];
+            }
+            model.col_index.resize(triplets.size());
+            model.values.resize(triplets.size());
+            vector<int64_t> next(model.row_start.begin(), model.row_start.end() - 1);
+            for (const Triplet& t : triplets) {
+                int64_t position = next[t.row]++;
+                model.col_index[position] = t.col;
+                model.values[position] = t.value;
+            }
+            triplets.clear();
+            triplets.shrink_to_fit();
+        }
+};
+
+}
+
+bool MpsModel::isBinary(int col) const {
+    char type = col_types[col];
+    if (type == 'B') {
+        return true;
+    }
+    return type == 'I' && lb[col] == 0.0 && ub[col] == 1.0;
+}
+
+MpsModel readMps(const string& path, const MpsReaderOptions& options) {
+    MappedFile file(path);
+    MpsParser parser(options);
+    return parser.parse(file.data, file.size);
+}
+
+MpsCounts getMpsCounts(const MpsModel& model) {
+    MpsCounts counts;
+    counts.num_vars = model.numVars();
+    counts.num_constrs = model.numConstrs();
+    counts.num_nonzeros = model.numNonzeros();
+    for (int col = 0; col < model.numVars(); col++) {
+        char type = model.col_types[col];
+        if (type == 'I' || type == 'B') {
+            counts.num_int_vars++;
+        }
+        if (model.isBinary(col)) {
+            counts.num_bin_vars++;
+        }
+    }
+    return counts;
+}
+
+MpsCounts countMps(const string& path) {
+    MpsReaderOptions options;
+    options.keep_names = false;
+    return getMpsCounts(readMps(path, options));
+}
+
+uint64_t hashFile(const string& path) {
+    MappedFile file(path);
+    // Hash 8 bytes per step, byte-wise FNV is too slow for multi GB collections
+    uint64_t hash = 14695981039346656037ull;
+    size_t i = 0;
+    for (; i + 8 <= file.size; i += 8) {
+        uint64_t word;
+        memcpy(&word, file.data + i, 8);
+        hash ^= word;
+        hash *= 1099511628211ull;
+        hash ^= hash >> 32;
+    }
+    for (; i < file.size; i++) {
+        hash ^= (uint8_t)file.data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
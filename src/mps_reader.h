@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+const double MPS_INFINITY = 1e100; // same value as GRB_INFINITY
+
+struct MpsReaderOptions {
+    // Upper bound of integer columns declared between INTORG/INTEND markers 
+    // without an explicit bound. Gurobi leaves them unbounded, other readers use 1.
+    double integer_marker_ub = MPS_INFINITY;
+    bool keep_names = true;
+};
+
+// Constraint matrix and column data read from an MPS file. The matrix is 
+// stored by rows (CSR): the nonzeros of row i are at [row_start[i], row_start[i + 1]).
+struct MpsModel {
+    string name;
+    int sense = 1; // 1 minimize, -1 maximize
+    double obj_constant = 0.0;
+
+    vector<string> row_names;
+    vector<char> row_types; // 'L', 'G' or 'E'
+    vector<double> rhs;
+    vector<double> ranges; // 0 when the row has no range
+
+    vector<string> col_names;
+    vector<char> col_types; // 'C', 'I', 'B' or 'S' (semi-continuous)
+    vector<double> obj;
+    vector<double> lb;
+    vector<double> ub;
+
+    vector<int64_t> row_start;
+    vector<int> col_index;
+    vector<double> values;
+
+    int numVars() const { return col_types.size(); }
+    int numConstrs() const { return row_types.size(); }
+    int64_t numNonzeros() const { return values.size(); }
+    // Same definition as isBinary in model_arrays.h
+    bool isBinary(int col) const;
+};
+
+struct MpsCounts {
+    int num_vars = 0;
+    int num_constrs = 0;
+    int64_t num_nonzeros = 0;
+    int num_bin_vars = 0; // binary or integer with bounds [0, 1]
+    int num_int_vars = 0; // all integer variables, binaries included
+};
+
+// Memory maps the file and parses it in a single pass without Gurobi. 
+// Fields are whitespace separated (free MPS), which also covers fixed MPS
+// files without spaces in names. Throws runtime_error on malformed input.
+MpsModel readMps(const string& path, const MpsReaderOptions& options = {});
+MpsCounts getMpsCounts(const MpsModel& model);
+MpsCounts countMps(const string& path);
+
+// 64-bit FNV style hash of the file content, used to detect changed instances
+uint64_t hashFile(const string& path);
@@ -0,0 +1,265 @@
+#include "neighborhood.h"
+#include "db.h"
+#include "load_model.h"
+#include "sampler.h"
+#include "utils.h"
+#include "fmt/core.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+// Fills the column side of the index by transposing the rows
+static void buildColumns(VarConstraintIndex& index) {
+    index.col_start.assign(index.num_vars + 1, 0);
+    for (int j : index.row_vars) {
+        index.col_start[j + 1]++;
+    }
+    for (int j = 0; j < index.num_vars; j++) {
+        index.col_start[j + 1] += index.col_start[j];
+    }
+    index.col_rows.resize(index.row_vars.size());
+    vector<int64_t> next(index.col_start.begin(), index.col_start.end() - 1);
+    for (int c = 0; c < index.num_constrs; c++) {
+        for (int64_t k = index.row_start[c]; k < index.row_start[c + 1]; k++) {
+            index.col_rows[next[index.row_vars[k]]++] = c;
+        }
+    }
+}
+
+VarConstraintIndex VarConstraintIndex::fromMps(const MpsModel& model) {
+    VarConstraintIndex index;
+    vector<int> position(model.numVars(), -1);
+    for (int col = 0; col < model.numVars(); col++) {
+        if (model.isBinary(col)) {
+            position[col] = index.num_vars++;
+        }
+    }
+
+    index.num_constrs = model.numConstrs();
+    index.row_start.reserve(index.num_constrs + 1);
+    index.row_start.push_back(0);
+    for (int row = 0; row < index.num_constrs; row++) {
+        for (int64_t k = model.row_start[row]; k < model.row_start[row + 1]; k++) {
+            int j = position[model.col_index[k]];
+            if (j >= 0) {
+                index.row_vars.push_back(j);
+            }
+        }
+        index.row_start.push_back(index.row_vars.size());
+    }
+    buildColumns(index);
+    return index;
+}
+
+VarConstraintIndex VarConstraintIndex::fromModel(GRBModel& model, vector<GRBVar>& binary_variables) {
+    VarConstraintIndex index;
+    index.num_vars = binary_variables.size();
+    vector<int> position(model.get(GRB_IntAttr_NumVars), -1);
+    for (int j = 0; j < index.num_vars; j++) {
+        position[binary_variables[j].index()] = j;
+    }
+
+    index.num_constrs = model.get(GRB_IntAttr_NumConstrs);
+    unique_ptr<GRBConstr[]> constrs(model.getConstrs());
+    index.row_start.reserve(index.num_constrs + 1);
+    index.row_start.push_back(0);
+    for (int c = 0; c < index.num_constrs; c++) {
+        GRBLinExpr row = model.getRow(constrs[c]);
+        for (int k = 0; k < row.size(); k++) {
+            int j = position[row.getVar(k).index()];
+            if (j >= 0) {
+                index.row_vars.push_back(j);
+            }
+        }
+        index.row_start.push_back(index.row_vars.size());
+    }
+    buildColumns(index);
+    return index;
+}
+
+shared_ptr<const VarConstraintIndex> buildVarConstraintIndex(const string& instance_name, GRBModel& model, vector<GRBVar>& binary_variables) {
+    auto start = chrono::steady_clock::now();
+    shared_ptr<VarConstraintIndex> index;
+    try {
+        index = make_shared<VarConstraintIndex>(VarConstraintIndex::fromMps(readMps(getMpsPath(instance_name), {.keep_names = false})));
+    } catch (exception& e) {
+        fmt::print("Native MPS reader failed on {}: {}\n", instance_name, e.what());
+    }
+    if (!index || index->num_vars != binary_variables.size()) {
+        index = make_shared<VarConstraintIndex>(VarConstraintIndex::fromModel(model, binary_variables));
+    }
+    double elapsed_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    fmt::print("Built variable-constraint index of {} in {:.0f} ms\n", instance_name, elapsed_ms);
+    return index;
+}
+
+NeighborhoodGenerator::NeighborhoodGenerator(shared_ptr<const VarConstraintIndex> index, int max_row_size)
+    : index(index),
+      max_row_size(max_row_size),
+      var_mark(index->num_vars, 0),
+      row_mark(index->num_constrs, 0) {}
+
+void NeighborhoodGenerator::nextEpoch() {
+    epoch++;
+    if (epoch == 0) {
+        fill(var_mark.begin(), var_mark.end(), 0);
+        fill(row_mark.begin(), row_mark.end(), 0);
+        epoch = 1;
+    }
+    free_vars.clear();
+}
+
+bool NeighborhoodGenerator::addVar(int j) {
+    if (var_mark[j] == epoch) {
+        return false;
+    }
+    var_mark[j] = epoch;
+    free_vars.push_back(j);
+    return true;
+}
+
+// A variable outside the neighborhood, found by a few random probes and then a scan
+int NeighborhoodGenerator::randomVar(mt19937& rng) {
+    int j = boundedRand(rng, index->num_vars);
+    for (int attempt = 0; attempt < 8 && var_mark[j] == epoch; attempt++) {
+        j = boundedRand(rng, index->num_vars);
+    }
+    for (int k = 0; k < index->num_vars && var_mark[j] == epoch; k++) {
+        j = j + 1 == index->num_vars ? 0 : j + 1;
+    }
+    return j;
+}
+
+vector<int> NeighborhoodGenerator::fixingIndices() {
+    vector<int> fixing_indices;
+    fixing_indices.reserve(index->num_vars - free_vars.size());
+    for (int j = 0; j < index->num_vars; j++) {
+        if (var_mark[j] != epoch) {
+            fixing_indices.push_back(j);
+        }
+    }
+    return fixing_indices;
+}
+
+vector<int> NeighborhoodGenerator::bfs(int num_free, mt19937& rng) {
+    nextEpoch();
+    num_free = min(num_free, index->num_vars);
+    while (free_vars.size() < num_free) {
+        int seed = randomVar(rng);
+        addVar(seed);
+        queue.assign(1, seed);
+        for (int head = 0; head < queue.size() && free_vars.size() < num_free; head++) {
+            int j = queue[head];
+            for (int64_t p = index->col_start[j]; p < index->col_start[j + 1] && free_vars.size() < num_free; p++) {
+                int c = index->col_rows[p];
+                if (row_mark[c] == epoch || index->rowSize(c) > max_row_size) {
+                    continue;
+                }
+                row_mark[c] = epoch;
+                for (int64_t k = index->row_start[c]; k < index->row_start[c + 1] && free_vars.size() < num_free; k++) {
+                    if (addVar(index->row_vars[k])) {
+                        queue.push_back(index->row_vars[k]);
+                    }
+                }
+            }
+        }
+    }
+    return fixingIndices();
+}
+
+vector<int> NeighborhoodGenerator::randomWalk(int num_free, mt19937& rng) {
+    nextEpoch();
+    num_free = min(num_free, index->num_vars);
+    if (num_free == 0) {
+        return fixingIndices();
+    }
+    int current = randomVar(rng);
+    addVar(current);
+    int64_t steps = 20 * (int64_t)num_free;
+    while (free_vars.size() < num_free && steps-- > 0) {
+        int num_rows = index->colSize(current);
+        int c = num_rows == 0 ? -1 : index->col_rows[index->col_start[current] + boundedRand(rng, num_rows)];
+        if (c < 0 || index->rowSize(c) > max_row_size) {
+            current = randomVar(rng);
+            addVar(current);
+            continue;
+        }
+        current = index->row_vars[index->row_start[c] + boundedRand(rng, index->rowSize(c))];
+        addVar(current);
+    }
+    while (free_vars.size() < num_free) {
+        addVar(randomVar(rng));
+    }
+    return fixingIndices();
+}
+
+vector<int> NeighborhoodGenerator::blocks(int num_free, mt19937& rng) {
+    nextEpoch();
+    num_free = min(num_free, index->num_vars);
+    if (index->num_constrs > 0) {
+        for (int attempt = 0; free_vars.size() < num_free && attempt < 2 * index->num_constrs; attempt++) {
+            int c = boundedRand(rng, index->num_constrs);
+            if (row_mark[c] == epoch || index->rowSize(c) > max_row_size) {
+                continue;
+            }
+            row_mark[c] = epoch;
+            for (int64_t k = index->row_start[c]; k < index->row_start[c + 1] && free_vars.size() < num_free; k++) {
+                addVar(index->row_vars[k]);
+            }
+        }
+    }
+    while (free_vars.size() < num_free) {
+        addVar(randomVar(rng));
+    }
+    return fixingIndices();
+}
+
+vector<int> NeighborhoodGenerator::generate(const string& type, int num_free, mt19937& rng) {
+    if (type == "bfs") {
+        return bfs(num_free, rng);
+    }
+    if (type == "walk") {
+        return randomWalk(num_free, rng);
+    }
+    if (type == "block") {
+        return blocks(num_free, rng);
+    }
+    return sample_without_replacement(index->num_vars, max(0, index->num_vars - num_free), rng);
+}
+
+void benchmarkNeighborhoods() {
+    vector<Instance> instances = get_selected_instances();
+    sort(instances.begin(), instances.end(), [](const Instance& a, const Instance& b) {
+        return a.num_bin_variables > b.num_bin_variables;
+    });
+    instances.resize(min((size_t)5, instances.size()));
+
+    vector<string> types = {"random", "bfs", "walk", "block"};
+    int repetitions = 50;
+    fmt::print("{:<24} {:>10} {:>10}", "instance", "binaries", "index_ms");
+    for (string& type : types) {
+        fmt::print(" {:>10}", type + "_ms");
+    }
+    fmt::print("\n");
+    for (Instance& instance : instances) {
+        MpsModel mps = readMps(getMpsPath(instance.id), {.keep_names = false});
+        auto start = chrono::steady_clock::now();
+        auto index = make_shared<VarConstraintIndex>(VarConstraintIndex::fromMps(mps));
+        double index_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        NeighborhoodGenerator generator(index);
+        mt19937 rng(0);
+        int num_free = max(1, index->num_vars / 5);
+        fmt::print("{:<24} {:>10} {:>10.1f}", instance.id, index->num_vars, index_ms);
+        for (string& type : types) {
+            auto type_start = chrono::steady_clock::now();
+            for (int r = 0; r < repetitions; r++) {
+                generator.generate(type, num_free, rng);
+            }
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - type_start).count() / repetitions;
+            fmt::print(" {:>10.3f}", ms);
+        }
+        fmt::print("\n");
+    }
+}
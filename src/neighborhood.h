@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "gurobi_c++.h"
+#include "mps_reader.h"
+
+using namespace std;
+
+// Adjacency between binary variables and the constraints containing them, in CSR form
+// both ways. Variables are numbered by their position in the binary variable list, the
+// same numbering as solutions and fixing indices.
+struct VarConstraintIndex {
+    int num_vars = 0;
+    int num_constrs = 0;
+    vector<int64_t> row_start; // binaries of constraint c are row_vars[row_start[c], row_start[c + 1])
+    vector<int> row_vars;
+    vector<int64_t> col_start; // constraints of binary j are col_rows[col_start[j], col_start[j + 1])
+    vector<int> col_rows;
+
+    int rowSize(int c) const { return row_start[c + 1] - row_start[c]; }
+    int colSize(int j) const { return col_start[j + 1] - col_start[j]; }
+    size_t sizeBytes() const {
+        return sizeof(int64_t) * (row_start.size() + col_start.size()) + sizeof(int) * (row_vars.size() + col_rows.size());
+    }
+
+    static VarConstraintIndex fromMps(const MpsModel& model);
+    static VarConstraintIndex fromModel(GRBModel& model, vector<GRBVar>& binary_variables);
+};
+
+// Index of an instance, built from its MPS file (or from the model if the native reader
+// fails). Jobs share it through ModelCache::getVarConstraintIndex.
+shared_ptr<const VarConstraintIndex> buildVarConstraintIndex(const string& instance_name, GRBModel& model, vector<GRBVar>& binary_variables);
+
+// Structured neighborhoods over a VarConstraintIndex. The methods return the fixing
+// indices, i.e. every binary variable outside the neighborhood of num_free variables.
+// Visited marks are epoch stamps, so generating a neighborhood never clears O(n) state.
+class NeighborhoodGenerator {
+    public:
+        explicit NeighborhoodGenerator(shared_ptr<const VarConstraintIndex> index, int max_row_size = 1000);
+
+        // Breadth first search from random seed variables through shared constraints
+        vector<int> bfs(int num_free, mt19937& rng);
+        // Random walk variable -> constraint -> variable, restarting at dead ends
+        vector<int> randomWalk(int num_free, mt19937& rng);
+        // Every binary variable of randomly picked constraints
+        vector<int> blocks(int num_free, mt19937& rng);
+        // Dispatches on Job::neighborhood, "random" samples uniformly
+        vector<int> generate(const string& type, int num_free, mt19937& rng);
+
+    private:
+        shared_ptr<const VarConstraintIndex> index;
+        // Rows longer than this (e.g. cardinality rows over all variables) are not expanded
+        int max_row_size;
+        vector<uint32_t> var_mark;
+        vector<uint32_t> row_mark;
+        uint32_t epoch = 0;
+        vector<int> free_vars;
+        vector<int> queue;
+
+        void nextEpoch();
+        bool addVar(int j);
+        int randomVar(mt19937& rng);
+        vector<int> fixingIndices();
+};
+
+// Index build time and neighborhood generation time on the largest selected instances
+void benchmarkNeighborhoods();
@@ -0,0 +1,222 @@
+#include "net.h"
+#include "fmt/core.h"
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Frames above this size are treated as a corrupted stream
+const uint32_t MAX_MESSAGE_BYTES = 1u << 30;
+
+struct SocketAddress {
+    bool is_unix = false;
+    string path; // unix
+    string host; // tcp
+    string port;
+};
+
+static SocketAddress parseAddress(const string& address) {
+    SocketAddress parsed;
+    if (address.rfind("unix:", 0) == 0) {
+        parsed.is_unix = true;
+        parsed.path = address.substr(5);
+        return parsed;
+    }
+    string host_port = address.rfind("tcp:", 0) == 0 ? address.substr(4) : address;
+    size_t colon = host_port.rfind(':');
+    if (colon == string::npos) {
+        throw runtime_error(fmt::format("Invalid address {}, expected unix:<path> or tcp:<host>:<port>", address));
+    }
+    parsed.host = host_port.substr(0, colon);
+    parsed.port = host_port.substr(colon + 1);
+    return parsed;
+}
+
+static sockaddr_un unixAddress(const string& path) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw runtime_error(fmt::format("Unix socket path too long: {}", path));
+    }
+    strcpy(addr.sun_path, path.c_str());
+    return addr;
+}
+
+static addrinfo* resolve(const SocketAddress& parsed, bool passive) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+    addrinfo* result = nullptr;
+    const char* host = parsed.host.empty() || parsed.host == "*" ? nullptr : parsed.host.c_str();
+    int error = getaddrinfo(host, parsed.port.c_str(), &hints, &result);
+    if (error != 0) {
+        throw runtime_error(fmt::format("Cannot resolve {}:{}: {}", parsed.host, parsed.port, gai_strerror(error)));
+    }
+    return result;
+}
+
+int listenOn(const string& address) {
+    SocketAddress parsed = parseAddress(address);
+    int fd = -1;
+    if (parsed.is_unix) {
+        sockaddr_un addr = unixAddress(parsed.path);
+        unlink(parsed.path.c_str());
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    } else {
+        addrinfo* candidates = resolve(parsed, true);
+        for (addrinfo* candidate = candidates; candidate && fd < 0; candidate = candidate->ai_next) {
+            fd = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+            if (fd < 0) {
+                continue;
+            }
+            int reuse = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            if (bind(fd, candidate->ai_addr, candidate->ai_addrlen) != 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(candidates);
+    }
+    if (fd < 0 || listen(fd, 64) != 0) {
+        throw runtime_error(fmt::format("Cannot listen on {}: {}", address, strerror(errno)));
+    }
+    return fd;
+}
+
+int connectTo(const string& address) {
+    SocketAddress parsed = parseAddress(address);
+    int fd = -1;
+    if (parsed.is_unix) {
+        sockaddr_un addr = unixAddress(parsed.path);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    } else {
+        addrinfo* candidates = resolve(parsed, false);
+        for (addrinfo* candidate = candidates; candidate && fd < 0; candidate = candidate->ai_next) {
+            fd = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+            if (fd >= 0 && connect(fd, candidate->ai_addr, candidate->ai_addrlen) != 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(candidates);
+        if (fd >= 0) {
+            int no_delay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+        }
+    }
+    if (fd < 0) {
+        throw runtime_error(fmt::format("Cannot connect to {}: {}", address, strerror(errno)));
+    }
+    return fd;
+}
+
+int acceptConnection(int listen_fd, int timeout_ms) {
+    pollfd poll_fd = {listen_fd, POLLIN, 0};
+    if (poll(&poll_fd, 1, timeout_ms) <= 0) {
+        return -1;
+    }
+    return accept(listen_fd, nullptr, nullptr);
+}
+
+void closeListener(int listen_fd, const string& address) {
+    ::close(listen_fd);
+    SocketAddress parsed = parseAddress(address);
+    if (parsed.is_unix) {
+        unlink(parsed.path.c_str());
+    }
+}
+
+static bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+static bool readAll(int fd, char* data, size_t size, int timeout_ms) {
+    while (size > 0) {
+        if (timeout_ms > 0) {
+            pollfd poll_fd = {fd, POLLIN, 0};
+            if (poll(&poll_fd, 1, timeout_ms) <= 0) {
+                return false;
+            }
+        }
+        ssize_t received = recv(fd, data, size, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        data += received;
+        size -= received;
+    }
+    return true;
+}
+
+Connection::Connection(int fd) : fd(fd) {}
+
+Connection::~Connection() {
+    close();
+}
+
+void Connection::close() {
+    lock_guard<mutex> lock(send_mutex);
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool Connection::send(uint8_t type, const vector<char>& payload) {
+    lock_guard<mutex> lock(send_mutex);
+    if (fd < 0) {
+        return false;
+    }
+    uint32_t size = payload.size();
+    char header[5];
+    memcpy(header, &size, 4);
+    header[4] = type;
+    return writeAll(fd, header, sizeof(header)) && writeAll(fd, payload.data(), payload.size());
+}
+
+bool Connection::receive(uint8_t& type, vector<char>& payload, int timeout_ms) {
+    char header[5];
+    if (fd < 0 || !readAll(fd, header, sizeof(header), timeout_ms)) {
+        return false;
+    }
+    uint32_t size;
+    memcpy(&size, header, 4);
+    if (size > MAX_MESSAGE_BYTES) {
+        return false;
+    }
+    type = header[4];
+    payload.resize(size);
+    return readAll(fd, payload.data(), size, timeout_ms);
+}
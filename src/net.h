@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Socket addresses are "unix:<path>" or "tcp:<host>:<port>" ("<host>:<port>" for short).
+// Failures to listen or connect throw runtime_error.
+int listenOn(const string& address);
+int connectTo(const string& address);
+// -1 when no connection arrived within timeout_ms
+int acceptConnection(int listen_fd, int timeout_ms);
+void closeListener(int listen_fd, const string& address);
+
+// Framed messages over a stream socket: 4 byte length, 1 byte type, payload.
+// send() may be called from several threads, receive() from one.
+class Connection {
+    public:
+        explicit Connection(int fd);
+        ~Connection();
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+
+        // Returns false once the peer is gone
+        bool send(uint8_t type, const vector<char>& payload = {});
+        // Returns false when the peer closed the connection, it failed or nothing
+        // arrived within timeout_ms (0 waits forever)
+        bool receive(uint8_t& type, vector<char>& payload, int timeout_ms = 0);
+        void close();
+
+    private:
+        int fd;
+        mutex send_mutex;
+};
@@ -36,7 +36,7 @@ def get_instance_selection_base_query() -> str:
                     j.*,
                     ROW_NUMBER() OVER (PARTITION BY j.instance_id ORDER BY j.created_at DESC) as rn
                 FROM jobs j
-                WHERE j.group_name = 'grb_only'
+                WHERE j.group_name = 'grb_only' AND j.status = 'done'
             )
             WHERE rn = 1
         )
@@ -54,7 +54,7 @@ def get_instance_selection_base_query() -> str:
 
 def get_instance_selection_query() -> str: 
     base_query = get_instance_selection_base_query()
-    return base_query + "\n WHERE g.mip_gap > 0.05 AND g.mip_gap < 10 AND g.solution IS NOT NULL AND g.solution != ''"
+    return base_query + "\n WHERE g.mip_gap > 0.05 AND g.mip_gap < 10 AND (g.solution != '' OR length(g.solution_blob) > 0)"
 
 def get_instance_selection_base_df() -> pd.DataFrame:
     return query_to_df(get_instance_selection_base_query())
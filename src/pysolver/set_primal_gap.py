@@ -1,24 +1,73 @@
+import struct
+
 from .connection import get_connection, close_connection
 
+# Layout of incumbent_timelines.timeline_blob, see src/incumbent_timeline.h
+TIMELINE_HEADER = b"T\x01"
+TIMELINE_EVENT = struct.Struct("<4d")  # time_s, obj_val, bound, node_count
+
+# Same target as PRIMAL_TARGET_GAP in src/incumbent_timeline.h
+PRIMAL_TARGET_GAP = 0.01
+
+
+def decode_timeline(blob):
+    if blob is None or bytes(blob[:2]) != TIMELINE_HEADER:
+        return None
+    return [TIMELINE_EVENT.unpack_from(blob, offset) for offset in range(2, len(blob), TIMELINE_EVENT.size)]
+
+
+def bounded_primal_gap(obj_val, reference):
+    if abs(obj_val) < 1e-9 and abs(reference) < 1e-9:
+        return 0.0
+    if obj_val * reference < 0:
+        return 1.0
+    return min(1.0, abs(obj_val - reference) / max(abs(obj_val), abs(reference)))
+
+
+def primal_metrics(timeline, end_s, reference):
+    """Primal integral, time to first and time to target solution, as computePrimalMetrics in C++."""
+    if not timeline:
+        return end_s, -1.0, -1.0
+    end_s = max(end_s, timeline[-1][0])
+    integral = timeline[0][0]
+    time_to_target = -1.0
+    for i, (time_s, obj_val, _, _) in enumerate(timeline):
+        gap = bounded_primal_gap(obj_val, reference)
+        next_s = timeline[i + 1][0] if i + 1 < len(timeline) else end_s
+        integral += gap * (next_s - time_s)
+        if time_to_target < 0 and gap <= PRIMAL_TARGET_GAP:
+            time_to_target = time_s
+    return integral, timeline[0][0], time_to_target
+
+
 def set_primal_gap():
     """
     Computes the primal gap for each job and updates the grb_attributes table.
     The primal gap is defined as abs(obj_val - best_obj_val) / abs(best_obj_val).
+    Jobs compute it themselves when the best known objective exists, so only rows whose
+    primal_gap_ref differs from the current best_known_obj_val are recomputed, together
+    with their primal integral and time to target.
     """
-    
+
     query = """
     SELECT
         ga.id,
         ga.obj_val,
-        i.best_known_obj_val
+        ga.sol_count,
+        ga.runtime,
+        i.best_known_obj_val,
+        t.timeline_blob
     FROM
         grb_attributes ga
     JOIN
         jobs j ON ga.job_id = j.id
     JOIN
         instances i ON j.instance_id = i.id
+    LEFT JOIN
+        incumbent_timelines t ON t.job_id = ga.job_id
     WHERE
-        ga.sol_count > 0;
+        ga.primal_gap_ref IS NOT i.best_known_obj_val
+        AND (ga.sol_count > 0 OR t.job_id IS NOT NULL);
     """
 
     con = get_connection()
@@ -28,22 +77,34 @@ def set_primal_gap():
         results = cursor.fetchall()
 
         if not results:
-            print("No solutions found to compute primal gap.")
+            print("All primal gaps are up to date.")
             return
 
         updates = []
         for row in results:
-            ga_id, obj_val, best_obj_val = row
-            
-            if best_obj_val is not None and abs(best_obj_val) > 1e-9:
-                primal_gap = abs(obj_val - best_obj_val) / abs(best_obj_val)
-            else:
-                primal_gap = float('inf')
+            ga_id, obj_val, sol_count, runtime, best_obj_val, timeline_blob = row
 
-            updates.append((primal_gap, ga_id))
+            primal_gap = -1.0
+            if sol_count > 0:
+                if best_obj_val is not None and abs(best_obj_val) > 1e-9:
+                    primal_gap = abs(obj_val - best_obj_val) / abs(best_obj_val)
+                else:
+                    primal_gap = float('inf')
+
+            # Jobs from before the timeline keep primal_integral = -1
+            primal_integral, time_to_first, time_to_target = -1.0, -1.0, -1.0
+            timeline = decode_timeline(timeline_blob)
+            if timeline is not None and best_obj_val is not None:
+                primal_integral, time_to_first, time_to_target = primal_metrics(timeline, runtime, best_obj_val)
+
+            updates.append((primal_gap, best_obj_val, primal_integral, time_to_first, time_to_target, ga_id))
 
         cursor.executemany(
-            "UPDATE grb_attributes SET primal_gap = ? WHERE id = ?",
+            """
+            UPDATE grb_attributes
+            SET primal_gap = ?, primal_gap_ref = ?, primal_integral = ?, time_to_first_s = ?, time_to_target_s = ?
+            WHERE id = ?
+            """,
             updates
         )
         con.commit()
@@ -51,4 +112,3 @@ def set_primal_gap():
 
     finally:
         close_connection()
-
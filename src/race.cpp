@@ -0,0 +1,90 @@
+#include "race.h"
+#include "gurobi_c++.h"
+#include "fmt/core.h"
+#include <cmath>
+
+using namespace std;
+
+RaceState::RaceState(double target_gap, optional<double> target_obj)
+    : target_gap(target_gap), target_obj(target_obj), best_obj(GRB_INFINITY) {}
+
+void RaceState::start(int sense, int job_id, bool restricted) {
+    lock_guard<mutex> lock(race_mutex);
+    if (restricted) {
+        restricted_jobs.insert(job_id);
+    }
+    if (best_job_id < 0) {
+        this->sense = sense;
+        best_obj = sense == GRB_MAXIMIZE ? -GRB_INFINITY : GRB_INFINITY;
+    }
+}
+
+bool RaceState::isBetter(double candidate, double incumbent) const {
+    return sense == GRB_MAXIMIZE ? candidate > incumbent : candidate < incumbent;
+}
+
+void RaceState::offer(double obj_val, int job_id) {
+    bool reached_target = false;
+    {
+        lock_guard<mutex> lock(race_mutex);
+        if (!isBetter(obj_val, best_obj.load())) {
+            return;
+        }
+        best_obj = obj_val;
+        best_job_id = job_id;
+        reached_target = target_obj && !isBetter(*target_obj, obj_val);
+    }
+    // Any feasible solution at the target objective ends the race, restricted or not
+    if (reached_target) {
+        end(job_id);
+    }
+}
+
+void RaceState::checkBound(double bound) {
+    double best = getBestObj();
+    if (abs(best) >= GRB_INFINITY || isFinished()) {
+        return;
+    }
+    // Same definition as Gurobi's MIPGap
+    double gap = abs(bound - best) / max(abs(best), 1e-10);
+    if (gap <= target_gap) {
+        int job_id;
+        {
+            lock_guard<mutex> lock(race_mutex);
+            job_id = best_job_id;
+        }
+        // The best solution may come from a restricted racer, the bound proves it
+        end(job_id);
+    }
+}
+
+bool RaceState::finish(int job_id) {
+    {
+        lock_guard<mutex> lock(race_mutex);
+        if (restricted_jobs.count(job_id)) {
+            fmt::print("Job {} solved a restricted model, its optimality does not end the race\n", job_id);
+            return false;
+        }
+    }
+    return end(job_id);
+}
+
+bool RaceState::end(int job_id) {
+    lock_guard<mutex> lock(race_mutex);
+    if (finished.load()) {
+        return false;
+    }
+    winner_job_id = job_id;
+    finished = true;
+    fmt::print("Race finished, job {} wins with objective {}\n", job_id, best_obj.load());
+    return true;
+}
+
+int RaceState::decideWinner() {
+    lock_guard<mutex> lock(race_mutex);
+    if (!finished.load()) {
+        winner_job_id = best_job_id;
+        finished = true;
+    }
+    return winner_job_id;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <unordered_set>
+
+using namespace std;
+
+// Shared state of a portfolio of jobs racing on the same instance. Racers report their
+// incumbents and bounds from the callback, the first job that proves the shared best 
+// objective within target_gap (or reaches target_obj) ends the race and the other 
+// racers abort at their next callback.
+class RaceState {
+    public:
+        RaceState(double target_gap, optional<double> target_obj = nullopt);
+
+        // Called by every racer before optimizing, all racers share the instance sense.
+        // Restricted racers (LNS) solve a sub-MIP: their bound and optimality say nothing
+        // about the instance, they only offer incumbents.
+        void start(int sense, int job_id, bool restricted);
+        void offer(double obj_val, int job_id);
+        // Ends the race if the shared best is within target_gap of a full model racer's bound
+        void checkBound(double bound);
+        // A full model racer solved to optimality or to the target objective. Returns true
+        // for the job that ended the race, false for restricted racers
+        bool finish(int job_id);
+        // The job with the best objective wins a race that nobody finished
+        int decideWinner();
+
+        bool isFinished() const { return finished.load(memory_order_relaxed); }
+        double getTargetGap() const { return target_gap; }
+        optional<double> getTargetObj() const { return target_obj; }
+        double getBestObj() const { return best_obj.load(memory_order_relaxed); }
+
+    private:
+        mutex race_mutex;
+        double target_gap;
+        optional<double> target_obj;
+        int sense = 1;
+        atomic<double> best_obj;
+        int best_job_id = -1;
+        atomic<bool> finished{false};
+        int winner_job_id = -1;
+        unordered_set<int> restricted_jobs;
+
+        bool end(int winner_job_id);
+        bool isBetter(double candidate, double incumbent) const;
+};
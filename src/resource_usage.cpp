@@ -0,0 +1,50 @@
+#include "resource_usage.h"
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+
+using namespace std;
+
+static double seconds(const timeval& time) {
+    return time.tv_sec + time.tv_usec / 1e6;
+}
+
+// VmHWM, the high water mark of the resident set, or ru_maxrss without /proc
+static int64_t peakRssKb(const rusage& process) {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return stoll(line.substr(6));
+        }
+    }
+    return process.ru_maxrss;
+}
+
+ResourceSample sampleResources() {
+    rusage process = {};
+    rusage thread = {};
+    getrusage(RUSAGE_SELF, &process);
+    getrusage(RUSAGE_THREAD, &thread);
+    return ResourceSample{
+        .process_user_s = seconds(process.ru_utime),
+        .process_sys_s = seconds(process.ru_stime),
+        .thread_cpu_s = seconds(thread.ru_utime) + seconds(thread.ru_stime),
+        .minor_faults = process.ru_minflt,
+        .major_faults = process.ru_majflt,
+        .peak_rss_kb = peakRssKb(process),
+    };
+}
+
+void setResourceUsage(GRBAttributes& attributes, const ResourceSample& start, const ResourceSample& end, bool exclusive) {
+    attributes.thread_cpu_s = end.thread_cpu_s - start.thread_cpu_s;
+    attributes.peak_rss_mb = end.peak_rss_kb / 1024.0;
+    if (!exclusive) {
+        return;
+    }
+    attributes.cpu_user_s = end.process_user_s - start.process_user_s;
+    attributes.cpu_sys_s = end.process_sys_s - start.process_sys_s;
+    attributes.minor_faults = end.minor_faults - start.minor_faults;
+    attributes.major_faults = end.major_faults - start.major_faults;
+    attributes.peak_rss_delta_mb = (end.peak_rss_kb - start.peak_rss_kb) / 1024.0;
+}
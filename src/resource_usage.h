@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include "db.h"
+
+using namespace std;
+
+// Counters read at the start and the end of a job. getrusage gives the CPU time and
+// page faults, /proc/self/status the peak resident set size. Process counters include
+// the Gurobi threads, but also the other jobs when several workers share the process.
+struct ResourceSample {
+    double process_user_s = 0.0;
+    double process_sys_s = 0.0;
+    double thread_cpu_s = 0.0; // user + sys of the calling thread only, not of its Gurobi threads
+    int64_t minor_faults = 0;
+    int64_t major_faults = 0;
+    int64_t peak_rss_kb = 0;
+};
+
+ResourceSample sampleResources();
+// Stores the usage between start and end in the resource columns of attributes. The
+// process CPU times, faults and peak growth are only the job's own when it had the
+// process to itself (exclusive, i.e. a single worker), otherwise they stay -1.
+void setResourceUsage(GRBAttributes& attributes, const ResourceSample& start, const ResourceSample& end, bool exclusive);
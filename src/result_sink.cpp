@@ -0,0 +1,71 @@
+#include "result_sink.h"
+#include "incumbent_store.h"
+#include "trace.h"
+#include "fmt/core.h"
+
+using namespace std;
+
+DbSink& getDbSink() {
+    static DbSink sink;
+    return sink;
+}
+
+optional<Instance> DbSink::getInstance(const string& instance_id) {
+    lock_guard<mutex> lock(get_db_mutex());
+    if (auto instance = get_storage().get_pointer<Instance>(instance_id)) {
+        return *instance;
+    }
+    return nullopt;
+}
+
+void DbSink::writeMetrics(vector<CallbackMetric>& metrics) {
+    batch_insert_metrics(metrics);
+}
+
+void DbSink::writeResults(Job& job, JobResults& results) {
+    bool written;
+    {
+        TRACE_SPAN("db_write_results");
+        lock_guard<mutex> lock(get_db_mutex());
+        auto& storage = get_storage();
+        // One transaction for everything the job produced
+        written = storage.transaction([&] {
+            // Done only together with its results, a crash before this point reruns the job.
+            // A job whose lease expired and was claimed by another worker is left to it.
+            storage.update_all(
+                sqlite_orm::set(c(&Job::status) = "done", c(&Job::threads) = job.threads,
+                    c(&Job::cpu_set) = job.cpu_set, c(&Job::numa_node) = job.numa_node),
+                where(c(&Job::id) == job.id and c(&Job::status) == "running" and c(&Job::worker_id) == job.worker_id)
+            );
+            if (storage.changes() == 0) {
+                return false;
+            }
+            results.attributes.job_id = job.id;
+            storage.insert(results.attributes);
+            results.timeline.job_id = job.id;
+            storage.replace(results.timeline);
+
+            if (!results.lns_iterations.empty()) {
+                for (auto& iteration : results.lns_iterations) {
+                    iteration.job_id = job.id;
+                }
+                storage.insert_range(results.lns_iterations.begin(), results.lns_iterations.end());
+            }
+            if (!results.operator_stats.empty()) {
+                for (auto& op_stats : results.operator_stats) {
+                    op_stats.job_id = job.id;
+                }
+                storage.insert_range(results.operator_stats.begin(), results.operator_stats.end());
+            }
+            return true;
+        });
+    }
+    if (!written) {
+        fmt::print("Job {} lost its lease, its results are discarded\n", job.id);
+        return;
+    }
+
+    if (results.attributes.SolCount > 0) {
+        IncumbentStore::getInstance().offer(job.instance_id, results.attributes.ObjVal, results.solution, results.sense, job.id);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "db.h"
+
+using namespace std;
+
+// Everything a finished job writes
+struct JobResults {
+    GRBAttributes attributes;
+    IncumbentTimeline timeline;
+    vector<LNSIteration> lns_iterations;
+    vector<LNSOperatorStats> operator_stats;
+    vector<int> solution; // offered to the IncumbentStore, encoded in attributes.solution_blob
+    int sense = 1; // GRB_MINIMIZE or GRB_MAXIMIZE
+};
+
+// Destination of a job's results. Jobs solved in this process write to the local
+// database, jobs solved by a worker process send them to the coordinator (distributed.h).
+class ResultSink {
+    public:
+        virtual ~ResultSink() = default;
+
+        virtual optional<Instance> getInstance(const string& instance_id) = 0;
+        // Called from the MetricsCollector drain thread while the job runs
+        virtual void writeMetrics(vector<CallbackMetric>& metrics) = 0;
+        // Writes the results, marks the job done and offers the solution to the IncumbentStore
+        virtual void writeResults(Job& job, JobResults& results) = 0;
+};
+
+class DbSink : public ResultSink {
+    public:
+        optional<Instance> getInstance(const string& instance_id) override;
+        void writeMetrics(vector<CallbackMetric>& metrics) override;
+        void writeResults(Job& job, JobResults& results) override;
+};
+
+DbSink& getDbSink();
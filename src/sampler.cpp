@@ -0,0 +1,184 @@
+#include "sampler.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+uint32_t boundedRand(mt19937& rng, uint32_t bound) {
+    uint64_t product = (uint64_t)(uint32_t)rng() * bound;
+    uint32_t low = (uint32_t)product;
+    if (low < bound) {
+        // Reject the 2^32 mod bound values that would bias the result
+        uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            product = (uint64_t)(uint32_t)rng() * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return product >> 32;
+}
+
+double uniformReal(mt19937& rng) {
+    uint64_t high = (uint32_t)rng() >> 5;
+    uint64_t low = (uint32_t)rng() >> 6;
+    return (high * 67108864.0 + low) * (1.0 / 9007199254740992.0);
+}
+
+AliasTable::AliasTable(const vector<double>& input_weights) : weights(input_weights) {
+    int n = weights.size();
+    double total = 0.0;
+    for (double& w : weights) {
+        w = max(w, 0.0);
+        total += w;
+        num_positive += w > 0.0;
+    }
+    prob.assign(n, 1.0);
+    alias.resize(n);
+    iota(alias.begin(), alias.end(), 0);
+    if (num_positive == 0) {
+        return;
+    }
+
+    vector<double> scaled(n);
+    vector<int> small;
+    vector<int> large;
+    small.reserve(n);
+    large.reserve(n);
+    for (int i = 0; i < n; i++) {
+        scaled[i] = weights[i] * n / total;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        int s = small.back();
+        small.pop_back();
+        int l = large.back();
+        prob[s] = scaled[s];
+        alias[s] = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Leftovers are 1 up to rounding, a zero weight left over must still never be drawn
+    int heaviest = max_element(weights.begin(), weights.end()) - weights.begin();
+    for (int i : small) {
+        if (weights[i] == 0.0) {
+            prob[i] = 0.0;
+            alias[i] = heaviest;
+        }
+    }
+}
+
+int AliasTable::sample(mt19937& rng) const {
+    int i = boundedRand(rng, prob.size());
+    return uniformReal(rng) < prob[i] ? i : alias[i];
+}
+
+void Sampler::nextEpoch(int n) {
+    if (marks.size() < n) {
+        marks.resize(n, 0);
+    }
+    epoch++;
+    if (epoch == 0) {
+        fill(marks.begin(), marks.end(), 0);
+        epoch = 1;
+    }
+}
+
+bool Sampler::mark(int i) {
+    if (marks[i] == epoch) {
+        return false;
+    }
+    marks[i] = epoch;
+    return true;
+}
+
+// Floyd: for j = n - k, ..., n - 1 add a random t <= j, or j itself if t was taken
+void Sampler::sampleFloyd(int n, int k, mt19937& rng) {
+    nextEpoch(n);
+    result.clear();
+    for (int j = n - k; j < n; j++) {
+        int t = boundedRand(rng, j + 1);
+        if (!mark(t)) {
+            mark(j);
+            t = j;
+        }
+        result.push_back(t);
+    }
+}
+
+void Sampler::samplePartialShuffle(int n, int k, mt19937& rng) {
+    if (population.size() != n) {
+        population.resize(n);
+        iota(population.begin(), population.end(), 0);
+    }
+    swaps.resize(k);
+    for (int i = 0; i < k; i++) {
+        swaps[i] = i + boundedRand(rng, n - i);
+        swap(population[i], population[swaps[i]]);
+    }
+    result.assign(population.begin(), population.begin() + k);
+    for (int i = k - 1; i >= 0; i--) {
+        swap(population[i], population[swaps[i]]);
+    }
+}
+
+const vector<int>& Sampler::sample(int n, int k, mt19937& rng) {
+    k = clamp(k, 0, max(n, 0));
+    bool complement = 2 * (int64_t)k > n;
+    int draws = complement ? n - k : k;
+    if (16 * (int64_t)draws < n) {
+        sampleFloyd(n, draws, rng);
+    } else {
+        samplePartialShuffle(n, draws, rng);
+    }
+    if (complement) {
+        nextEpoch(n);
+        for (int i : result) {
+            mark(i);
+        }
+        result.clear();
+        for (int i = 0; i < n; i++) {
+            if (marks[i] != epoch) {
+                result.push_back(i);
+            }
+        }
+    }
+    return result;
+}
+
+const vector<int>& Sampler::sampleWeighted(const AliasTable& table, int k, mt19937& rng) {
+    int n = table.size();
+    k = clamp(k, 0, table.numPositive());
+    nextEpoch(n);
+    result.clear();
+
+    // Rejecting repeated draws is cheap while the drawn indices hold little of the
+    // weight. Once the rejections cost about as much as a rebuild, the table is
+    // rebuilt without them.
+    const AliasTable* current = &table;
+    AliasTable remaining;
+    int64_t rejections = 0;
+    while (result.size() < k) {
+        int i = current->sample(rng);
+        if (mark(i)) {
+            result.push_back(i);
+        } else if (++rejections > n / 4 + 64) {
+            vector<double> weights(n);
+            for (int j = 0; j < n; j++) {
+                weights[j] = marks[j] == epoch ? 0.0 : table.weight(j);
+            }
+            remaining = AliasTable(weights);
+            current = &remaining;
+            rejections = 0;
+        }
+    }
+    return result;
+}
+
+void Sampler::shuffle(vector<int>& values, mt19937& rng) {
+    for (int i = (int)values.size() - 1; i > 0; i--) {
+        swap(values[i], values[boundedRand(rng, i + 1)]);
+    }
+}
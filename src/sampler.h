@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+// Uniform integer in [0, bound) from the raw mt19937 output (Lemire's multiply and
+// reject). uniform_int_distribution and shuffle are implementation defined, so the
+// same seed would give different neighborhoods with libstdc++ and libc++.
+uint32_t boundedRand(mt19937& rng, uint32_t bound);
+// Uniform double in [0, 1) with 53 random bits
+double uniformReal(mt19937& rng);
+
+// Walker's alias method (Vose's construction): O(n) to build, O(1) per draw.
+// Negative weights count as zero.
+class AliasTable {
+    public:
+        AliasTable() = default;
+        explicit AliasTable(const vector<double>& weights);
+
+        int size() const { return weights.size(); }
+        int numPositive() const { return num_positive; }
+        double weight(int i) const { return weights[i]; }
+        // Index drawn with probability weight(i) / sum of weights, requires numPositive() > 0
+        int sample(mt19937& rng) const;
+
+    private:
+        vector<double> weights;
+        vector<double> prob;
+        vector<int> alias;
+        int num_positive = 0;
+};
+
+// Sampling without replacement with scratch buffers that are kept between calls.
+// Results only depend on the arguments and the generator state, not on earlier calls,
+// so a seed reproduces the same neighborhood on every platform.
+class Sampler {
+    public:
+        // k distinct values of {0, ..., n - 1} in unspecified order. Floyd's algorithm for
+        // sparse samples, a partial Fisher-Yates shuffle otherwise, and the complement of a
+        // sample of n - k when k > n / 2. The result is valid until the next call.
+        const vector<int>& sample(int n, int k, mt19937& rng);
+        // k distinct indices by successive weighted draws, i.e. every next index is drawn
+        // with probability proportional to its weight among the ones not drawn yet.
+        // k is capped at table.numPositive().
+        const vector<int>& sampleWeighted(const AliasTable& table, int k, mt19937& rng);
+        void shuffle(vector<int>& values, mt19937& rng);
+
+    private:
+        vector<int> result;
+        // Identity permutation, the partial shuffle undoes its swaps after every call
+        vector<int> population;
+        vector<int> swaps;
+        vector<uint32_t> marks;
+        uint32_t epoch = 0;
+
+        void nextEpoch(int n);
+        // Returns false if i was already marked in this epoch
+        bool mark(int i);
+        void sampleFloyd(int n, int k, mt19937& rng);
+        void samplePartialShuffle(int n, int k, mt19937& rng);
+};
@@ -0,0 +1,162 @@
+#include "solution_codec.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+static void writeVarint(vector<char>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back((char)value);
+}
+
+static uint64_t readVarint(const vector<char>& in, size_t& pos) {
+    uint64_t value = 0;
+    int shift = 0;
+    while (pos < in.size() && shift < 64) {
+        uint8_t byte = in[pos++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+        shift += 7;
+    }
+    throw runtime_error("Truncated varint in solution blob");
+}
+
+static size_t varintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+vector<char> encodeSolution(const vector<int>& indices, int num_vars) {
+    const vector<int>* sorted = &indices;
+    vector<int> sorted_copy;
+    if (!is_sorted(indices.begin(), indices.end())) {
+        sorted_copy = indices;
+        sort(sorted_copy.begin(), sorted_copy.end());
+        sorted = &sorted_copy;
+    }
+    if (!sorted->empty()) {
+        num_vars = max(num_vars, sorted->back() + 1);
+    }
+
+    size_t delta_size = 0;
+    int64_t previous = -1;
+    for (int index : *sorted) {
+        delta_size += varintSize(index - previous - 1);
+        previous = index;
+    }
+    size_t bitset_size = ((size_t)num_vars + 7) / 8;
+    SolutionEncoding encoding = bitset_size < delta_size ? SOLUTION_BITSET : SOLUTION_DELTA_VARINT;
+
+    vector<char> blob;
+    blob.reserve(16 + min(delta_size, bitset_size));
+    blob.push_back((char)SOLUTION_CODEC_MAGIC);
+    blob.push_back((char)SOLUTION_CODEC_VERSION);
+    blob.push_back((char)encoding);
+    writeVarint(blob, num_vars);
+    writeVarint(blob, sorted->size());
+
+    if (encoding == SOLUTION_BITSET) {
+        size_t offset = blob.size();
+        blob.resize(offset + bitset_size, 0);
+        for (int index : *sorted) {
+            blob[offset + index / 8] |= (char)(1 << (index % 8));
+        }
+    } else {
+        previous = -1;
+        for (int index : *sorted) {
+            writeVarint(blob, index - previous - 1);
+            previous = index;
+        }
+    }
+    return blob;
+}
+
+SolutionEncoding getSolutionEncoding(const vector<char>& blob) {
+    if (blob.size() < 3 || (uint8_t)blob[0] != SOLUTION_CODEC_MAGIC) {
+        throw runtime_error("Not a solution blob");
+    }
+    if ((uint8_t)blob[1] != SOLUTION_CODEC_VERSION) {
+        throw runtime_error("Unsupported solution blob version " + to_string((int)(uint8_t)blob[1]));
+    }
+    return (SolutionEncoding)blob[2];
+}
+
+vector<int> decodeSolution(const vector<char>& blob) {
+    SolutionEncoding encoding = getSolutionEncoding(blob);
+    size_t pos = 3;
+    uint64_t num_vars = readVarint(blob, pos);
+    uint64_t count = readVarint(blob, pos);
+
+    // Every index is a distinct variable, and takes at least one payload byte as a delta
+    // or one bit of the bitset, so a larger count is a corrupt header
+    uint64_t payload_size = blob.size() - pos;
+    uint64_t capacity = min<uint64_t>(num_vars, encoding == SOLUTION_BITSET ? 8 * payload_size : payload_size);
+    if (count > capacity) {
+        throw runtime_error("Solution blob count " + to_string(count) + " exceeds the " + to_string(capacity) + " indices its payload can hold");
+    }
+
+    vector<int> indices;
+    indices.reserve(count);
+    if (encoding == SOLUTION_BITSET) {
+        size_t bitset_size = (num_vars + 7) / 8;
+        if (blob.size() - pos < bitset_size) {
+            throw runtime_error("Truncated bitset in solution blob");
+        }
+        const char* bits = blob.data() + pos;
+        size_t word_index = 0;
+        // Scan 64 bits at a time and jump straight to the set bits (little endian hosts)
+        for (; (word_index + 1) * 8 <= bitset_size; word_index++) {
+            uint64_t word;
+            memcpy(&word, bits + word_index * 8, 8);
+            while (word != 0) {
+                int bit = __builtin_ctzll(word);
+                indices.push_back((int)(word_index * 64 + bit));
+                word &= word - 1;
+            }
+        }
+        for (size_t byte = word_index * 8; byte < bitset_size; byte++) {
+            uint8_t value = bits[byte];
+            for (int bit = 0; bit < 8; bit++) {
+                if (value & (1 << bit)) {
+                    indices.push_back((int)(byte * 8 + bit));
+                }
+            }
+        }
+    } else if (encoding == SOLUTION_DELTA_VARINT) {
+        int64_t previous = -1;
+        for (uint64_t i = 0; i < count; i++) {
+            previous += (int64_t)readVarint(blob, pos) + 1;
+            indices.push_back((int)previous);
+        }
+    } else {
+        throw runtime_error("Unknown solution encoding " + to_string((int)encoding));
+    }
+
+    if (indices.size() != count) {
+        throw runtime_error("Solution blob count does not match its payload");
+    }
+    return indices;
+}
+
+vector<int> parseSolutionString(const string& solution_str) {
+    stringstream ss(solution_str);
+    string item;
+    vector<int> solution;
+    while (getline(ss, item, ',')) {
+        if (!item.empty()) {
+            solution.push_back(stoi(item));
+        }
+    }
+    return solution;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Binary encoding of a solution, the sorted indices of the non zero binary variables.
+//
+// Layout: magic 'S', version, encoding, varint num_vars, varint count, payload
+//  - SOLUTION_DELTA_VARINT: gaps between consecutive indices as LEB128 varints
+//  - SOLUTION_BITSET: one bit per binary variable, little endian
+// The encoding producing the smaller payload is picked for every solution.
+const uint8_t SOLUTION_CODEC_MAGIC = 'S';
+const uint8_t SOLUTION_CODEC_VERSION = 1;
+
+enum SolutionEncoding : uint8_t {
+    SOLUTION_DELTA_VARINT = 0,
+    SOLUTION_BITSET = 1,
+};
+
+vector<char> encodeSolution(const vector<int>& indices, int num_vars);
+// Throws runtime_error when the blob is truncated or has an unknown header
+vector<int> decodeSolution(const vector<char>& blob);
+SolutionEncoding getSolutionEncoding(const vector<char>& blob);
+
+// Legacy comma separated text format, kept to migrate existing rows
+vector<int> parseSolutionString(const string& solution_str);
@@ -0,0 +1,34 @@
+#include "solution_exchange.h"
+#include "gurobi_c++.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+bool SolutionExchange::isBetter(double candidate, double incumbent) const {
+    double tolerance = 1e-9 * max(1.0, abs(incumbent));
+    if (sense == GRB_MAXIMIZE) {
+        return candidate > incumbent + tolerance;
+    }
+    return candidate < incumbent - tolerance;
+}
+
+bool SolutionExchange::publish(double obj_val, vector<double> values, int source) {
+    auto next = make_shared<ExchangeSolution>();
+    next->obj_val = obj_val;
+    next->values = move(values);
+    next->source = source;
+
+    shared_ptr<const ExchangeSolution> expected = atomic_load(&current);
+    do {
+        if (expected && !isBetter(obj_val, expected->obj_val)) {
+            return false;
+        }
+        next->version = expected ? expected->version + 1 : 1;
+    } while (!atomic_compare_exchange_weak(&current, &expected, shared_ptr<const ExchangeSolution>(next)));
+    // Concurrent publishers may finish out of order, the counter only moves forward
+    uint64_t published = current_version.load(memory_order_relaxed);
+    while (published < next->version && !current_version.compare_exchange_weak(published, next->version, memory_order_release)) {
+    }
+    return true;
+}
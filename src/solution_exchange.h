@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+struct ExchangeSolution {
+    double obj_val;
+    vector<double> values; // every model variable, in model order
+    int source; // -1 for the main solve, k for LNS helper k
+    uint64_t version;
+};
+
+// Best solution shared between a running main solve and its LNS helpers. Solutions 
+// are immutable and swapped in with a compare and exchange on a shared_ptr. The
+// atomic shared_ptr functions are not lock-free (libstdc++ guards them with a pool
+// of spinlocks), so readers poll the lock-free version counter and only load the
+// solution when it changed, which keeps the Gurobi callback off the spinlock.
+class SolutionExchange {
+    public:
+        explicit SolutionExchange(int sense) : sense(sense) {}
+
+        // Returns true when the solution is better than the current one and was published
+        bool publish(double obj_val, vector<double> values, int source);
+        shared_ptr<const ExchangeSolution> latest() const { return atomic_load(&current); }
+        uint64_t version() const { return current_version.load(memory_order_acquire); }
+        bool isBetter(double candidate, double incumbent) const;
+
+    private:
+        int sense;
+        shared_ptr<const ExchangeSolution> current;
+        atomic<uint64_t> current_version{0};
+};
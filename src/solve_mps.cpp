@@ -3,96 +3,35 @@
 #include "utils.h"
 #include "load_model.h"
 #include "binary_variables.h"
+#include "executor.h"
+#include "lns.h"
+#include "neighborhood.h"
+#include "model_cache.h"
+#include "bound_fixer.h"
+#include "solution_codec.h"
+#include "incumbent_store.h"
+#include "callback_state.h"
+#include "race.h"
+#include "hybrid.h"
+#include "incumbent_timeline.h"
+#include "termination.h"
+#include "metrics_collector.h"
+#include "result_sink.h"
+#include "grb_env.h"
+#include "trace.h"
+#include "resource_usage.h"
+#include "cpu_topology.h"
 
 #include "gurobi_c++.h"
 #include "fmt/core.h"
 #include <string>
 #include <chrono>
-#include <fstream>
 #include <cstdlib>
+#include <cmath>
+#include <limits>
 
 using namespace std;
 
-class CallbackState: public GRBCallback
-{
-  public:
-    CallbackState(GRBVar* binary_vars, int num_binary_vars, string instance_name) {
-        this->instance_name = instance_name;
-        this->binary_vars = binary_vars;
-        this->num_binary_vars = num_binary_vars;
-        start_time = chrono::steady_clock::now();
-    }
-
-    void printSummary() {
-      fmt::print("Summary:\n");
-      // Print the number of solutions found
-      fmt::print("Number of solutions found using callback: {}\n", metrics.size());
-    }
-
-    vector<CallbackMetric>& getMetrics() {
-        return metrics;
-    }
-
-    void saveMetricsCSV() {
-        string filename = fmt::format("data/{}_metrics.csv", instance_name);
-        ofstream file(filename);
-        file << "non_zero_count,phase,solcnt,elapsed_ms,instance_name\n";
-        for (const auto& metric : metrics) {
-            file << metric.non_zero_count << "," 
-                << metric.phase << "," 
-                << metric.solcnt << "," 
-                << metric.elapsed_ms << ","
-                << instance_name
-                << endl;
-        }
-        file.close();
-    }
-
-  private:
-    GRBVar* binary_vars;
-    int num_binary_vars;
-    vector<CallbackMetric> metrics;
-    chrono::steady_clock::time_point start_time;
-    int error_count = 0;
-    string instance_name;
-    
-    void handleMipNode() {
-      int solcnt = getIntInfo(GRB_CB_MIPNODE_SOLCNT);
-      int phase = getIntInfo(GRB_CB_MIPNODE_PHASE);
-      double* x = getNodeRel(binary_vars, num_binary_vars);
-
-      vector<int> non_zero_indices;
-      for (int i = 0; i < num_binary_vars; i++) {
-        double value = x[i];
-        if (value > 0.0) {
-            non_zero_indices.push_back(i);
-        }
-      }
-      auto now = chrono::steady_clock::now();
-      auto elapsed_ms = chrono::duration_cast<chrono::milliseconds>(now - start_time).count();
-      int non_zero_count = non_zero_indices.size();
-      metrics.push_back({
-        .non_zero_count = non_zero_count, 
-        .phase = phase, 
-        .solcnt = solcnt, 
-        .elapsed_ms = elapsed_ms,
-      }); 
-      delete[] x;
-    }
-
-  protected:
-    void callback () {
-      try {
-        if (where == GRB_CB_MIPNODE) {
-          handleMipNode();
-        }
-      } catch (GRBException e) {
-        error_count++;
-      }
-    }
-};
-
-
 GRBAttributes createGRBAttributes(GRBModel& model) {
   return GRBAttributes{
     .MIPGap = model.get(GRB_DoubleAttr_MIPGap), 
@@ -106,136 +45,301 @@ GRBAttributes createGRBAttributes(GRBModel& model) {
     .NumConstrs = model.get(GRB_IntAttr_NumConstrs),
     .NumBinVars = model.get(GRB_IntAttr_NumBinVars),
     .NumIntVars = model.get(GRB_IntAttr_NumIntVars),
+    .Work = model.get(GRB_DoubleAttr_Work),
+    .IterCount = model.get(GRB_DoubleAttr_IterCount),
+    .BarIterCount = model.get(GRB_IntAttr_BarIterCount),
   };
 }
 
-static void applyWarmStart(const string& instance_name, vector<GRBVar>& binary_variables) {
-    auto best_solution = get_best_solution_for_instance_from_db(instance_name);
+static void applyWarmStart(GRBModel& model, const string& instance_name, vector<GRBVar>& binary_variables) {
+    TRACE_SPAN("warm_start");
+    auto best_solution = IncumbentStore::getInstance().get(instance_name);
     if (!best_solution) {
         fmt::print("No best solution found for instance, skipping warm start\n");
         return;
     }
 
-    // start by setting all binary variables to 0
-    for (int i = 0; i < binary_variables.size(); i++) {
-        binary_variables[i].set(GRB_DoubleAttr_Start, 0.0);
-    }
-
+    // Binary variables outside the solution start at 0
     fmt::print("Found best solution for instance, applying warm start\n");
-    vector<int> solution = *best_solution;
-    for (int var_index : solution) {
-        binary_variables[var_index].set(GRB_DoubleAttr_Start, 1.0);
-    }
+    vector<double> start = solution_to_values(best_solution->solution, binary_variables.size());
+    setAttrArray(model, GRB_DoubleAttr_Start, binary_variables.data(), start);
 }
 
-void applyLNS(GRBModel& model, Job& job) {
+void applyLNS(GRBModel& model, Job& job, vector<GRBVar>& binary_variables) {
+    TRACE_SPAN("apply_lns");
     string instance_name = job.instance_id;
-    auto best_solution = get_best_solution_for_instance_from_db(instance_name);
+    auto best_solution = IncumbentStore::getInstance().get(instance_name);
     if (!best_solution) {
         fmt::print("No best solution found for instance, skipping LNS\n");
         return;
     }
     // We use random LNS where we sample without replacement binary_variables (fixing_ratio * num_binary_variables) 
-    vector<int> one_indices = *best_solution;
-    vector<GRBVar> binary_variables = getBinaryVariables(model);
     int num_binary_variables = binary_variables.size();
-    vector<int> fixing_indices = sample_percentage(num_binary_variables, job.fixing_ratio, job.seed);
-
-    // build solution 
-    vector<float> solution; 
-    for (int i = 0; i < num_binary_variables; i++) {
-        solution.push_back(0.0);
+    vector<int> fixing_indices;
+    {
+        TRACE_SPAN("lns_neighborhood");
+        if (job.neighborhood == "random") {
+            fixing_indices = sample_percentage(num_binary_variables, job.fixing_ratio, job.seed);
+        } else {
+            NeighborhoodGenerator generator(ModelCache::getInstance().getVarConstraintIndex(instance_name, model, binary_variables));
+            mt19937 rng(job.seed);
+            int num_free = num_binary_variables - (int)(num_binary_variables * job.fixing_ratio);
+            fixing_indices = generator.generate(job.neighborhood, num_free, rng);
+        }
     }
-    for (int var_index : one_indices) {
-        solution[var_index] = 1.0;
+    vector<double> solution = solution_to_values(best_solution->solution, num_binary_variables);
+    TRACE_SPAN("lns_fix");
+
+    if (job.fixing_method == "bounds") {
+        // The model is discarded after the job, so the bounds are never restored
+        BoundFixer fixer(model, binary_variables);
+        fixer.fix(fixing_indices, solution);
+        fmt::print("Fixed bounds of {} variables\n", fixing_indices.size());
+        fixer.release();
+        return;
     }
+    addFixingConstraint(model, binary_variables, solution, fixing_indices);
+    fmt::print("Added LNS constraint with {} variables fixed\n", fixing_indices.size());
+}
+
+GRBAttributes createLNSAttributes(GRBModel& model, LNSResult& result) {
+  return GRBAttributes{
+    .MIPGap = -1.0, // no global bound in LNS
+    .Runtime = result.runtime_s,
+    .SolCount = result.has_solution ? 1 : 0,
+    .NodeCount = result.node_count, 
+    .Status = result.status,
+    .ObjVal = result.obj_val,
+    .MaxMemUsed = model.get(GRB_DoubleAttr_MaxMemUsed),
+    .NumVars = model.get(GRB_IntAttr_NumVars),
+    .NumConstrs = model.get(GRB_IntAttr_NumConstrs),
+    .NumBinVars = model.get(GRB_IntAttr_NumBinVars),
+    .NumIntVars = model.get(GRB_IntAttr_NumIntVars),
+    .Work = result.work,
+    .IterCount = result.iter_count,
+    .BarIterCount = result.bar_iter_count,
+  };
+}
 
-    // add LNS constraint 
-    GRBLinExpr lns_expression = 0;
-    for (int var_index : fixing_indices) {
-        GRBVar var = binary_variables[var_index];
-        double value = solution[var_index];
-        lns_expression += var * (1 - value); // if value is 0, we must fix var to 0
-        lns_expression += (1 - var) * value; // if value is 1, we must fix var to 1
+// Iterative LNS has no callback on the whole run, its improving iterations are the timeline
+static vector<IncumbentEvent> timelineFromIterations(const vector<LNSIteration>& iterations, int sense) {
+  vector<IncumbentEvent> timeline;
+  for (const LNSIteration& iteration : iterations) {
+    if (iteration.improved) {
+      timeline.push_back({
+        .time_s = iteration.elapsed_ms / 1000.0,
+        .obj_val = iteration.obj_val,
+        .bound = sense == GRB_MAXIMIZE ? GRB_INFINITY : -GRB_INFINITY,
+        .node_count = 0.0,
+      });
     }
-    model.addConstr(lns_expression == 0, "LNS");
-    fmt::print("Added LNS constraint with {} variables fixed\n", fixing_indices.size());
+  }
+  return timeline;
 }
 
-void _solveJob(Job job) {
+// Primal gap, primal integral and time to first/target solution against the best known 
+// objective of the instance. Without a best known objective the job's own objective is 
+// the reference and primal_gap_ref stays stale, so set_primal_gap.py recomputes the row.
+static void setPrimalMetrics(GRBAttributes& attributes, const vector<IncumbentEvent>& timeline, const Instance* instance) {
+  bool has_best_known = instance && instance->best_known_obj_val != 1e10;
+  if (attributes.SolCount == 0 && !has_best_known) {
+    return;
+  }
+  double reference = has_best_known ? instance->best_known_obj_val : attributes.ObjVal;
+  PrimalMetrics metrics = computePrimalMetrics(timeline, attributes.Runtime, reference);
+  attributes.primal_integral = metrics.primal_integral;
+  attributes.time_to_first_s = metrics.time_to_first_s;
+  attributes.time_to_target_s = metrics.time_to_target_s;
+  if (has_best_known && attributes.SolCount > 0) {
+    // Same definition as set_primal_gap.py
+    attributes.PrimalGap = abs(reference) > 1e-9 ? abs(attributes.ObjVal - reference) / abs(reference) : numeric_limits<double>::infinity();
+    attributes.primal_gap_ref = reference;
+  }
+}
+
+void _solveJob(Job job, GRBEnv& env, RaceState* race, ResultSink& sink) {
     string instance_name = job.instance_id;
-    GRBModel model = loadModel(instance_name);
-    model.set(GRB_DoubleParam_TimeLimit, job.time_limit_s);
+    // Queued jobs already have their row, other ones are written first so that the
+    // callback metrics and the trace can reference it
+    if (job.id <= 0) {
+      lock_guard<mutex> lock(get_db_mutex());
+      job.status = "running";
+      job.id = get_storage().insert(job);
+      fmt::print("Inserted job with id: {}\n", job.id);
+    }
+    TRACE_JOB(job.id);
+    TRACE_SPAN("solve_job");
+    ResourceSample resources_start = sampleResources();
+
+    unique_ptr<GRBModel> model_copy = ModelCache::getInstance().getModel(instance_name, env);
+    GRBModel& model = *model_copy;
+    setJobLimit(model, job, jobBudget(job, job.time_limit_s));
     model.set(GRB_IntParam_Seed, job.seed);
 
-    vector<GRBVar> binary_variables = getBinaryVariables(model);
+    ModelArrays arrays(model);
+    vector<GRBVar>& binary_variables = arrays.binary_vars;
 
-    if (job.warm_start) {
-        applyWarmStart(instance_name, binary_variables);
+    optional<Instance> instance;
+    {
+      TRACE_SPAN("instance_lookup");
+      instance = sink.getInstance(instance_name);
     }
+    double best_known_obj_val = instance ? instance->best_known_obj_val : 1e10;
 
-    if (job.enable_lns) {
-        applyLNS(model, job);
+    unique_ptr<MetricsCollector> collector;
+    if (job.enable_callback) {
+      collector = make_unique<MetricsCollector>(job.id, sink);
     }
-
     CallbackState callbackState(
       binary_variables.data(), 
       binary_variables.size(),
-      instance_name
+      instance_name,
+      collector.get(),
+      job.metrics_every_nodes,
+      job.metrics_every_ms
     );
 
-    if (job.enable_callback) {
+    // LNS racers solve a sub-MIP, only their incumbents count for the race
+    bool race_restricted = job.enable_lns || job.iterative_lns;
+    if (race) {
+      // Racers stop on their own at the target gap or objective, the callback stops the losers
+      race->start(model.get(GRB_IntAttr_ModelSense), job.id, race_restricted);
+      model.set(GRB_DoubleParam_MIPGap, race->getTargetGap());
+      if (race->getTargetObj()) {
+        model.set(GRB_DoubleParam_BestObjStop, *race->getTargetObj());
+      }
+      callbackState.setRace(race, job.id, race_restricted);
+    }
+
+    if (job.enable_callback || race) {
       model.setCallback(&callbackState);
     }
-    model.optimize();
 
-    fmt::print("Objective: {}\n", model.get(GRB_DoubleAttr_ObjVal));
+    GRBAttributes attributes;
+    vector<int> solution;
+    vector<IncumbentEvent> timeline;
+    vector<LNSIteration> lns_iterations;
+    vector<LNSOperatorStats> operator_stats;
+    if (job.iterative_lns) {
+      optional<vector<int>> start_solution;
+      auto best_solution = IncumbentStore::getInstance().get(instance_name);
+      if (job.warm_start && best_solution) {
+        start_solution = best_solution->solution;
+      }
+      LNSResult result = runIterativeLNS(model, job, binary_variables, start_solution);
+      attributes = createLNSAttributes(model, result);
+      solution = result.best_solution;
+      lns_iterations = result.iterations;
+      operator_stats = result.operator_stats;
+      attributes.termination_reason = result.termination_reason;
+      timeline = timelineFromIterations(lns_iterations, model.get(GRB_IntAttr_ModelSense));
+    } else {
+      if (job.warm_start) {
+        applyWarmStart(model, instance_name, binary_variables);
+      }
 
-    auto storage = get_storage();
-    int job_id = storage.insert(job);
-    job.id = job_id;
-    fmt::print("Inserted job with id: {}\n", job.id);
+      if (job.enable_lns) {
+        applyLNS(model, job, binary_variables);
+      }
 
-    GRBAttributes attributes = createGRBAttributes(model);
-    attributes.job_id = job.id;
-    if (model.get(GRB_IntAttr_SolCount) > 0) {
-      vector<int> solution = get_best_solution_from_model(model, binary_variables);
-      string solution_str = convertVectorToString(solution);
-      fmt::print("Found solution for instance: {}\n", instance_name);
-      attributes.solution = solution_str;
+      int sense = model.get(GRB_IntAttr_ModelSense);
+      callbackState.enableTimeline(sense);
+      TerminationPolicy termination({
+        .stall_time_s = job.stall_time_s,
+        .stall_nodes = (double)job.stall_nodes,
+        .min_gap_rate = job.min_gap_rate,
+      }, sense);
+      if (termination.enabled()) {
+        callbackState.setTermination(&termination);
+      }
+      bool stop_at_best_known = job.stop_at_best_known && best_known_obj_val != 1e10 && !race;
+      if (stop_at_best_known) {
+        model.set(GRB_DoubleParam_BestObjStop, best_known_obj_val);
+      }
+      model.setCallback(&callbackState);
+      if (job.lns_helpers > 0) {
+        lns_iterations = runHybrid(model, job, arrays, callbackState);
+      } else {
+        TRACE_SPAN("optimize");
+        model.optimize();
+      }
+      timeline = callbackState.getTimeline();
+      attributes = createGRBAttributes(model);
+      // The helper sub-MIPs are part of the job's effort
+      for (const LNSIteration& iteration : lns_iterations) {
+        attributes.Work += iteration.work;
+      }
+      if (race && !race_restricted && (attributes.Status == GRB_OPTIMAL || attributes.Status == GRB_USER_OBJ_LIMIT)) {
+        race->finish(job.id);
+      }
+      if (callbackState.getTerminationReason()) {
+        attributes.termination_reason = callbackState.getTerminationReason();
+      } else if (stop_at_best_known && attributes.Status == GRB_USER_OBJ_LIMIT) {
+        attributes.termination_reason = "best_known";
+      } else if (race && attributes.Status == GRB_INTERRUPTED) {
+        attributes.termination_reason = "race";
+      }
+      if (model.get(GRB_IntAttr_SolCount) > 0) {
+        TRACE_SPAN("get_solution");
+        solution = get_best_solution_from_model(model, binary_variables);
+      }
     }
 
-    storage.insert(attributes);
+    fmt::print("Objective: {}\n", attributes.ObjVal);
 
-    // TODO: pass in job id to callbackState at construction time
-    //auto& metrics = callbackState.getMetrics();
-    //for (auto& metric : metrics) {
-    //    metric.job_id = job.id;
-    //}
-    //batch_insert_metrics(metrics);
+    if (collector) {
+      collector->stop();
+      callbackState.printSummary();
+    }
+
+    JobResults results = {
+      .attributes = attributes,
+      .timeline = {
+        .job_id = job.id,
+        .num_events = (int)timeline.size(),
+        .timeline_blob = encodeTimeline(timeline),
+      },
+      .lns_iterations = lns_iterations,
+      .operator_stats = operator_stats,
+      .solution = solution,
+      .sense = model.get(GRB_IntAttr_ModelSense),
+    };
+    if (results.attributes.SolCount > 0) {
+      fmt::print("Found solution for instance: {}\n", instance_name);
+      TRACE_SPAN("encode_solution");
+      results.attributes.solution_blob = encodeSolution(solution, binary_variables.size());
+    }
+    setPrimalMetrics(results.attributes, timeline, instance ? &*instance : nullptr);
+    // With several workers the process counters mix the jobs running side by side
+    setResourceUsage(results.attributes, resources_start, sampleResources(), getExecutorConfig().workers <= 1);
+    TRACE_SPAN("write_results");
+    sink.writeResults(job, results);
 }
 
-void solveJob(Job job) {
+void solveJob(Job& job, GRBEnv& env, ResultSink& sink) {
     try {
-        _solveJob(job);
+        _solveJob(job, env, nullptr, sink);
     } catch (GRBException e) {
         fmt::print("Error: {}\n", e.getMessage());
     }
 }
 
+static void solveLocalJob(Job& job, GRBEnv& env) {
+    solveJob(job, env, getDbSink());
+}
+
 void solveGRBOnly() { 
   vector<Instance> instances = get_instances();
-  int instance_count = instances.size();
-  for (int i = 0; i < instance_count; i++) {
-    fmt::print("Solving instance {}/{}\n", i + 1, instance_count);
-    Instance instance = instances[i];
+  vector<Job> jobs;
+  for (Instance& instance : instances) {
     Job job = {
       .instance_id = instance.id,
       .time_limit_s = 10,
       .group_name = "grb_only",
     };
-    solveJob(job);
+    jobs.push_back(job);
   }
+  runJobs(jobs, solveLocalJob);
 }
 
 void solveWarmStart() {
@@ -258,9 +362,7 @@ void solveWarmStart() {
       jobs.push_back(job);
     }
   }
-  for (Job& job : jobs) {
-    solveJob(job);
-  }
+  runJobs(jobs, solveLocalJob);
 }
 
 void solveLNS() {
@@ -288,8 +390,359 @@ void solveLNS() {
     }
   }
   fmt::print("Solving {} jobs\n", jobs.size());
-  for (Job& job : jobs) {
-    solveJob(job);
+  runJobs(jobs, solveLocalJob);
+}
+
+void solveIterativeLNS() {
+  fmt::print("Running job group: iterative_lns\n");
+  vector<Instance> instances = get_selected_instances();
+  vector<Job> jobs;
+  vector<float> fixing_ratios = {0.2, 0.5, 0.8};
+  vector<int> seeds = {0, 1, 2};
+  for (float fixing_ratio : fixing_ratios) {
+    string group_name = fmt::format("ilns_{:.2f}", fixing_ratio);
+    for (int seed : seeds) {
+      for (Instance& instance : instances) {
+        Job job = {
+          .instance_id = instance.id,
+          .time_limit_s = 10,
+          .group_name = group_name,
+          .warm_start = true,
+          .enable_lns = true,
+          .seed = seed,
+          .fixing_ratio = fixing_ratio,
+          .iterative_lns = true,
+          .sub_mip_time_s = 1.0,
+        };
+        jobs.push_back(job);
+      }
+    }
+  }
+  fmt::print("Solving {} jobs\n", jobs.size());
+  runJobs(jobs, solveLocalJob);
+}
+
+// Compares bound fixing with the single fixing row on the same iterative LNS jobs
+void solveLNSFixingBenchmark() {
+  fmt::print("Running job group: lns_fixing\n");
+  vector<Instance> instances = get_selected_instances();
+  vector<Job> jobs;
+  vector<string> fixing_methods = {"constraint", "bounds"};
+  vector<int> seeds = {0, 1, 2};
+  for (string& fixing_method : fixing_methods) {
+    string group_name = fmt::format("lns_fixing_{}", fixing_method);
+    for (int seed : seeds) {
+      for (Instance& instance : instances) {
+        Job job = {
+          .instance_id = instance.id,
+          .time_limit_s = 10,
+          .group_name = group_name,
+          .warm_start = true,
+          .enable_lns = true,
+          .seed = seed,
+          .fixing_ratio = 0.8,
+          .iterative_lns = true,
+          .sub_mip_time_s = 1.0,
+          .fixing_method = fixing_method,
+        };
+        jobs.push_back(job);
+      }
+    }
+  }
+  runJobs(jobs, solveLocalJob);
+
+  lock_guard<mutex> lock(get_db_mutex());
+  auto& storage = get_storage();
+  auto rows = storage.select(
+    columns(&Job::fixing_method, count(&LNSIteration::id), avg(&LNSIteration::fixing_time_ms), avg(&LNSIteration::sub_mip_time_s)),
+    join<Job>(on(c(&LNSIteration::job_id) == &Job::id)),
+    where(c(&Job::group_name) == "lns_fixing_constraint" or c(&Job::group_name) == "lns_fixing_bounds"),
+    group_by(&Job::fixing_method)
+  );
+  fmt::print("{:<12} {:>10} {:>16} {:>16}\n", "method", "iterations", "fixing_ms", "sub_mip_s");
+  for (auto& row : rows) {
+    fmt::print("{:<12} {:>10} {:>16.3f} {:>16.3f}\n", std::get<0>(row), std::get<1>(row), std::get<2>(row), std::get<3>(row));
+  }
+}
+
+// Adaptive LNS on the same budget as lns_iter, with a summary of how each operator paid off
+void solveAdaptiveLNS() {
+  fmt::print("Running job group: alns\n");
+  vector<Instance> instances = get_selected_instances();
+  vector<Job> jobs;
+  vector<int> seeds = {0, 1, 2};
+  for (int seed : seeds) {
+    for (Instance& instance : instances) {
+      Job job = {
+        .instance_id = instance.id,
+        .time_limit_s = 10,
+        .group_name = "alns",
+        .warm_start = true,
+        .enable_lns = true,
+        .seed = seed,
+        .fixing_ratio = 0.5,
+        .iterative_lns = true,
+        .sub_mip_time_s = 1.0,
+        .fixing_method = "bounds",
+        .adaptive_lns = true,
+      };
+      jobs.push_back(job);
+    }
+  }
+  runJobs(jobs, solveLocalJob);
+
+  lock_guard<mutex> lock(get_db_mutex());
+  auto& storage = get_storage();
+  auto rows = storage.select(
+    columns(&LNSOperatorStats::operator_name, total(&LNSOperatorStats::selections), total(&LNSOperatorStats::improvements), total(&LNSOperatorStats::total_time_s)),
+    join<Job>(on(c(&LNSOperatorStats::job_id) == &Job::id)),
+    where(c(&Job::group_name) == "alns"),
+    group_by(&LNSOperatorStats::operator_name)
+  );
+  fmt::print("{:<16} {:>10} {:>12} {:>10}\n", "operator", "selections", "improvements", "time_s");
+  for (auto& row : rows) {
+    fmt::print("{:<16} {:>10.0f} {:>12.0f} {:>10.1f}\n", std::get<0>(row), std::get<1>(row), std::get<2>(row), std::get<3>(row));
+  }
+}
+
+// Main B&B with LNS helpers against plain Gurobi and plain iterative LNS on the same budget
+void solveHybrid() {
+  fmt::print("Running job group: hybrid\n");
+  vector<Instance> instances = get_selected_instances();
+  vector<Job> jobs;
+  for (int seed : {0, 1, 2}) {
+    for (Instance& instance : instances) {
+      Job grb = {
+        .instance_id = instance.id,
+        .time_limit_s = 10,
+        .group_name = "hybrid_grb",
+        .warm_start = true,
+        .seed = seed,
+      };
+      jobs.push_back(grb);
+      Job lns = {
+        .instance_id = instance.id,
+        .time_limit_s = 10,
+        .group_name = "hybrid_lns",
+        .warm_start = true,
+        .enable_lns = true,
+        .seed = seed,
+        .fixing_ratio = 0.5,
+        .iterative_lns = true,
+        .sub_mip_time_s = 1.0,
+        .fixing_method = "bounds",
+      };
+      jobs.push_back(lns);
+      for (int helpers : {2, 4}) {
+        Job hybrid = {
+          .instance_id = instance.id,
+          .time_limit_s = 10,
+          .group_name = fmt::format("hybrid_{}", helpers),
+          .warm_start = true,
+          .seed = seed,
+          .fixing_ratio = 0.5,
+          .sub_mip_time_s = 1.0,
+          .fixing_method = "bounds",
+          .lns_helpers = helpers,
+        };
+        jobs.push_back(hybrid);
+      }
+    }
+  }
+  runJobs(jobs, solveLocalJob);
+}
+
+// Runs the same jobs with each early termination policy and without, then compares
+// the runtime saved with the primal gap lost (run compute_metrics first for the gaps)
+void solveStallBenchmark() {
+  fmt::print("Running job group: stall\n");
+  vector<Instance> instances = get_selected_instances();
+  vector<Job> policies = {
+    {.group_name = "stall_off"},
+    {.group_name = "stall_time_2s", .stall_time_s = 2},
+    {.group_name = "stall_nodes_5000", .stall_nodes = 5000},
+    {.group_name = "stall_gap_rate", .min_gap_rate = 0.001},
+    {.group_name = "stall_best_known", .stop_at_best_known = true},
+  };
+  vector<Job> jobs;
+  for (Job& policy : policies) {
+    for (int seed : {0, 1, 2}) {
+      for (Instance& instance : instances) {
+        Job job = policy;
+        job.instance_id = instance.id;
+        job.time_limit_s = 10;
+        job.seed = seed;
+        jobs.push_back(job);
+      }
+    }
+  }
+  runJobs(jobs, solveLocalJob);
+
+  lock_guard<mutex> lock(get_db_mutex());
+  auto& storage = get_storage();
+  auto rows = storage.select(
+    columns(&Job::group_name, count(&GRBAttributes::id), avg(&GRBAttributes::Runtime), avg(&GRBAttributes::PrimalGap), avg(&GRBAttributes::primal_integral)),
+    join<Job>(on(c(&GRBAttributes::job_id) == &Job::id)),
+    where(like(&Job::group_name, "stall_%")),
+    group_by(&Job::group_name)
+  );
+  fmt::print("{:<18} {:>6} {:>10} {:>12} {:>16}\n", "group", "jobs", "runtime_s", "primal_gap", "primal_integral");
+  for (auto& row : rows) {
+    fmt::print("{:<18} {:>6} {:>10.2f} {:>12.5f} {:>16.4f}\n", std::get<0>(row), std::get<1>(row), std::get<2>(row), std::get<3>(row), std::get<4>(row));
+  }
+}
+
+// Runs the same jobs on --workers workers without and with CPU pinning, then compares
+// the throughput and the spread of the job runtimes
+void solvePinningBenchmark() {
+  ExecutorConfig& config = getExecutorConfig();
+  if (config.workers < 2) {
+    fmt::print("Pinning only matters for concurrent jobs, use --workers\n");
+  }
+  vector<Instance> instances = get_selected_instances();
+  // Both modes start with every model cached, the first one would pay for the parsing
+  {
+    unique_ptr<GRBEnv> env = GurobiEnvironment::createEnv(1, false);
+    for (Instance& instance : instances) {
+      ModelCache::getInstance().getModel(instance.id, *env);
+    }
+  }
+
+  // Both modes run the same Threads, the pinned core count per worker. Unpinned jobs
+  // would otherwise split the logical CPUs and run twice the threads on SMT hosts
+  int threads_per_job = config.threads_per_job;
+  if (config.threads_per_job == 0 && config.work_limit == 0) {
+    config.threads_per_job = max(1, (int)detectTopology().cores.size() / max(1, config.workers));
+  }
+  fmt::print("Both modes run {} threads per job\n", getThreadsPerJob(config));
+
+  // Group names of this run, the queue skips jobs completed by earlier runs
+  int64_t run = unix_now();
+  bool pin_cpus = config.pin_cpus;
+  struct ModeRun {
+    string mode;
+    string group_name;
+    double wall_s;
+  };
+  vector<ModeRun> mode_runs;
+  for (bool pinned : {false, true}) {
+    string mode = pinned ? "pinned" : "unpinned";
+    string group_name = fmt::format("pin_bench_{}_{}", mode, run);
+    vector<Job> jobs;
+    for (int seed : {0, 1, 2}) {
+      for (Instance& instance : instances) {
+        Job job = {
+          .instance_id = instance.id,
+          .time_limit_s = 10,
+          .group_name = group_name,
+          .seed = seed,
+        };
+        jobs.push_back(job);
+      }
+    }
+    config.pin_cpus = pinned;
+    auto start = chrono::steady_clock::now();
+    runJobs(jobs, solveLocalJob);
+    mode_runs.push_back({mode, group_name, chrono::duration<double>(chrono::steady_clock::now() - start).count()});
+  }
+  config.pin_cpus = pin_cpus;
+  config.threads_per_job = threads_per_job;
+
+  lock_guard<mutex> lock(get_db_mutex());
+  auto& storage = get_storage();
+  fmt::print("{:<10} {:>6} {:>8} {:>10} {:>12} {:>12} {:>8}\n", "mode", "jobs", "wall_s", "jobs_per_h", "runtime_avg", "runtime_sd", "cv");
+  for (ModeRun& mode_run : mode_runs) {
+    vector<double> runtimes = storage.select(
+      &GRBAttributes::Runtime,
+      join<Job>(on(c(&GRBAttributes::job_id) == &Job::id)),
+      where(c(&Job::group_name) == mode_run.group_name)
+    );
+    double mean = 0.0;
+    for (double runtime : runtimes) {
+      mean += runtime / runtimes.size();
+    }
+    double variance = 0.0;
+    for (double runtime : runtimes) {
+      variance += (runtime - mean) * (runtime - mean) / max<size_t>(1, runtimes.size() - 1);
+    }
+    double sd = sqrt(variance);
+    fmt::print("{:<10} {:>6} {:>8.1f} {:>10.1f} {:>12.3f} {:>12.3f} {:>8.3f}\n",
+      mode_run.mode, runtimes.size(), mode_run.wall_s, runtimes.size() * 3600.0 / mode_run.wall_s, mean, sd, mean > 0 ? sd / mean : 0.0);
+  }
+}
+
+// Races a portfolio of configurations on each selected instance. The racers of an instance 
+// run concurrently and stop as soon as one of them proves the shared best objective within
+// the target gap or reaches the best known objective of the instance.
+void solveRace() {
+  fmt::print("Running job group: race\n");
+  vector<Instance> instances = get_selected_instances();
+  double target_gap = 1e-4;
+  // Racers abort each other, so every run is a new race rather than a resume of the last
+  // one: the run id is part of the racers' params_key
+  int64_t race_id = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+
+  for (Instance& instance : instances) {
+    vector<Job> jobs;
+    for (int seed : {0, 1, 2}) {
+      Job job = {
+        .instance_id = instance.id,
+        .time_limit_s = 10,
+        .group_name = "race",
+        .seed = seed,
+      };
+      jobs.push_back(job);
+    }
+    Job warm_start = {
+      .instance_id = instance.id,
+      .time_limit_s = 10,
+      .group_name = "race",
+      .warm_start = true,
+    };
+    jobs.push_back(warm_start);
+    for (float fixing_ratio : {0.2f, 0.5f}) {
+      Job lns = {
+        .instance_id = instance.id,
+        .time_limit_s = 10,
+        .group_name = "race",
+        .warm_start = true,
+        .enable_lns = true,
+        .fixing_ratio = fixing_ratio,
+        .fixing_method = "bounds",
+      };
+      jobs.push_back(lns);
+    }
+    for (Job& job : jobs) {
+      job.race_id = race_id;
+    }
+    if (getExecutorConfig().workers < jobs.size()) {
+      fmt::print("Only {} of {} racers run at once, use --workers {} for a full race\n", 
+        getExecutorConfig().workers, jobs.size(), jobs.size());
+    }
+
+    // Instances are seeded with the 1e10 placeholder when no objective is known
+    optional<double> target_obj;
+    if (instance.best_known_obj_val != 1e10) {
+      target_obj = instance.best_known_obj_val;
+    }
+    RaceState race(target_gap, target_obj);
+    runJobs(jobs, [&](Job& job, GRBEnv& env) {
+      try {
+        _solveJob(job, env, &race, getDbSink());
+      } catch (GRBException e) {
+        fmt::print("Error: {}\n", e.getMessage());
+      }
+    }, false);
+
+    int winner_job_id = race.decideWinner();
+    fmt::print("Race on {} won by job {} with objective {}\n", instance.id, winner_job_id, race.getBestObj());
+    if (winner_job_id >= 0) {
+      lock_guard<mutex> lock(get_db_mutex());
+      get_storage().update_all(
+        sqlite_orm::set(c(&GRBAttributes::winner) = true),
+        where(c(&GRBAttributes::job_id) == winner_job_id)
+      );
+    }
   }
 }
 
@@ -302,6 +755,7 @@ void solveSelectedInstances() {
     }
   }
   fmt::print("Solving {} selected instances\n", selected_instances.size());
+  vector<Job> jobs;
   for (Instance& instance : selected_instances) {
     Job job = {
       .instance_id = instance.id,
@@ -310,6 +764,7 @@ void solveSelectedInstances() {
       .enable_lns = true,
       .fixing_ratio = 0.20,
     };
-    solveJob(job);
+    jobs.push_back(job);
   }
+  runJobs(jobs, solveLocalJob);
 }
\ No newline at end of file
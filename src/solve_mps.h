@@ -1,6 +1,19 @@
 #pragma once
 
+#include "db.h"
+#include "result_sink.h"
+#include "gurobi_c++.h"
+
+// Solves one job and writes its results to the sink, Gurobi errors are printed
+void solveJob(Job& job, GRBEnv& env, ResultSink& sink);
 
 void solveGRBOnly();
 void solveWarmStart();
-void solveLNS();
\ No newline at end of file
+void solveLNS();
+void solveIterativeLNS();
+void solveLNSFixingBenchmark();
+void solveAdaptiveLNS();
+void solveRace();
+void solveHybrid();
+void solveStallBenchmark();
+void solvePinningBenchmark();
\ No newline at end of file
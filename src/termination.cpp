@@ -0,0 +1,48 @@
+#include "termination.h"
+#include "gurobi_c++.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+TerminationPolicy::TerminationPolicy(const TerminationConfig& config, int sense) : config(config), sense(sense) {}
+
+bool TerminationPolicy::enabled() const {
+    return config.stall_time_s > 0 || config.stall_nodes > 0 || config.min_gap_rate > 0;
+}
+
+const char* TerminationPolicy::check(double runtime_s, double node_count, double obj_best, double obj_bound) {
+    // OBJBST is +-GRB_INFINITY until the first incumbent
+    if (abs(obj_best) >= GRB_INFINITY) {
+        return nullptr;
+    }
+    bool improved = !has_incumbent || (sense == GRB_MAXIMIZE ? obj_best > best_obj : obj_best < best_obj);
+    if (improved) {
+        has_incumbent = true;
+        best_obj = obj_best;
+        improved_at_s = runtime_s;
+        improved_at_node = node_count;
+    }
+
+    if (config.stall_time_s > 0 && runtime_s - improved_at_s >= config.stall_time_s) {
+        return "stall_time";
+    }
+    if (config.stall_nodes > 0 && node_count - improved_at_node >= config.stall_nodes) {
+        return "stall_nodes";
+    }
+
+    if (config.min_gap_rate > 0) {
+        double gap = abs(obj_best - obj_bound) / max(abs(obj_best), 1e-10);
+        if (gap_history.empty() || runtime_s - gap_history.back().first >= 0.5) {
+            gap_history.emplace_back(runtime_s, gap);
+        }
+        while (gap_history.size() > 1 && runtime_s - gap_history[1].first >= config.gap_rate_window_s) {
+            gap_history.pop_front();
+        }
+        double window_s = runtime_s - gap_history.front().first;
+        if (window_s >= config.gap_rate_window_s && (gap_history.front().second - gap) / window_s < config.min_gap_rate) {
+            return "gap_rate";
+        }
+    }
+    return nullptr;
+}
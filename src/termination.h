@@ -0,0 +1,35 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+// Early termination policies, all disabled at 0
+struct TerminationConfig {
+    double stall_time_s = 0.0; // no incumbent improvement for this many seconds
+    double stall_nodes = 0.0; // no incumbent improvement for this many nodes
+    double min_gap_rate = 0.0; // MIP gap closed per second over the last gap_rate_window_s
+    double gap_rate_window_s = 5.0;
+};
+
+// Evaluated from the MIP callback. Returns the name of the first policy that fires,
+// the job then aborts and stores it as its termination_reason.
+class TerminationPolicy {
+    public:
+        TerminationPolicy(const TerminationConfig& config, int sense);
+
+        bool enabled() const;
+        // Returns nullptr while the solve should continue
+        const char* check(double runtime_s, double node_count, double obj_best, double obj_bound);
+
+    private:
+        TerminationConfig config;
+        int sense;
+        bool has_incumbent = false;
+        double best_obj = 0.0;
+        double improved_at_s = 0.0;
+        double improved_at_node = 0.0;
+        deque<pair<double, double>> gap_history; // (runtime_s, gap), sampled every 0.5s
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Runs fn(index, worker_id) for every index in [0, n) on `workers` threads.
+// Indices are handed out in increasing order, so callers control the
+// execution order by sorting their inputs.
+inline void parallel_for(int n, int workers, const function<void(int, int)>& fn) {
+    if (workers <= 1 || n <= 1) {
+        for (int i = 0; i < n; i++) {
+            fn(i, 0);
+        }
+        return;
+    }
+
+    atomic<int> next_index{0};
+    vector<thread> threads;
+    int num_threads = min(workers, n);
+    threads.reserve(num_threads);
+    for (int worker_id = 0; worker_id < num_threads; worker_id++) {
+        threads.emplace_back([&, worker_id]() {
+            int i;
+            while ((i = next_index.fetch_add(1)) < n) {
+                fn(i, worker_id);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
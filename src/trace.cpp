@@ -0,0 +1,130 @@
+#ifdef SOLVER_TRACING
+
+#include "trace.h"
+#include "fmt/core.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+namespace tracing {
+
+// Spans past this count are dropped, a trace is written at the end of each job
+const size_t MAX_EVENTS_PER_THREAD = 1 << 20;
+
+struct Event {
+    const char* name;
+    int64_t start_ns;
+    int64_t end_ns;
+    int job_id;
+};
+
+struct ThreadBuffer {
+    int tid = 0;
+    mutex buffer_mutex; // only contended while a trace is written
+    vector<Event> events;
+    int64_t dropped = 0;
+    atomic<bool> alive{true};
+};
+
+static mutex registry_mutex;
+static vector<shared_ptr<ThreadBuffer>> registry;
+static int next_tid = 1;
+static const chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+
+// Registers the buffer of a thread on its first span, the buffer outlives the
+// thread until its spans are written
+struct ThreadHandle {
+    shared_ptr<ThreadBuffer> buffer = make_shared<ThreadBuffer>();
+    int job_id = 0;
+
+    ThreadHandle() {
+        lock_guard<mutex> lock(registry_mutex);
+        buffer->tid = next_tid++;
+        registry.push_back(buffer);
+    }
+    ~ThreadHandle() {
+        buffer->alive = false;
+    }
+};
+
+static thread_local ThreadHandle handle;
+
+int64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+void record(const char* name, int64_t start_ns, int64_t end_ns) {
+    ThreadBuffer& buffer = *handle.buffer;
+    lock_guard<mutex> lock(buffer.buffer_mutex);
+    if (buffer.events.size() >= MAX_EVENTS_PER_THREAD) {
+        buffer.dropped++;
+        return;
+    }
+    buffer.events.push_back({name, start_ns, end_ns, handle.job_id});
+}
+
+void setThreadJob(int job_id) {
+    handle.job_id = job_id;
+}
+
+int getThreadJob() {
+    return handle.job_id;
+}
+
+void writeTrace(int job_id) {
+    vector<pair<int, Event>> events; // tid, span
+    int64_t dropped = 0;
+    {
+        lock_guard<mutex> lock(registry_mutex);
+        for (auto& buffer : registry) {
+            lock_guard<mutex> buffer_lock(buffer->buffer_mutex);
+            auto job_begin = stable_partition(buffer->events.begin(), buffer->events.end(), [&](const Event& event) {
+                return event.job_id != job_id;
+            });
+            for (auto it = job_begin; it != buffer->events.end(); ++it) {
+                events.push_back({buffer->tid, *it});
+            }
+            buffer->events.erase(job_begin, buffer->events.end());
+            dropped += buffer->dropped;
+            buffer->dropped = 0;
+        }
+        registry.erase(remove_if(registry.begin(), registry.end(), [](const shared_ptr<ThreadBuffer>& buffer) {
+            lock_guard<mutex> buffer_lock(buffer->buffer_mutex);
+            return !buffer->alive && buffer->events.empty();
+        }), registry.end());
+    }
+    if (events.empty()) {
+        return;
+    }
+
+    filesystem::create_directories("traces");
+    string path = job_id != 0 ? fmt::format("traces/job_{}.json", job_id) : fmt::format("traces/process_{}.json", getpid());
+    ofstream file(path);
+    // Complete events ("X"), timestamps in microseconds
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    int pid = job_id != 0 ? job_id : getpid();
+    for (size_t i = 0; i < events.size(); i++) {
+        const auto& [tid, event] = events[i];
+        file << fmt::format("{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":{},\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}{}\n",
+            event.name, pid, tid, event.start_ns / 1000.0, (event.end_ns - event.start_ns) / 1000.0,
+            i + 1 < events.size() ? "," : "");
+    }
+    file << "]}\n";
+    fmt::print("Wrote {} trace spans to {}\n", events.size(), path);
+    if (dropped > 0) {
+        fmt::print("Dropped {} trace spans, thread buffers were full\n", dropped);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+
+// Scoped spans of the solver hot paths, exported as Chrome trace JSON (open the
+// files in ui.perfetto.dev or chrome://tracing). Only built with -DENABLE_TRACING=ON,
+// otherwise the macros expand to nothing.
+//
+//   TRACE_JOB(job.id);      this thread works for the job until the end of the scope,
+//                           the job's spans are written to traces/job_<id>.json then
+//   TRACE_THREAD(job.id);   helper threads of a job record into the job's trace
+//   TRACE_SPAN("optimize"); span from here to the end of the scope, names are literals
+//   TRACE_FLUSH();          spans outside of jobs go to traces/process_<pid>.json
+//
+// Each thread appends to its own buffer, a span costs two clock reads and an
+// uncontended lock.
+#ifdef SOLVER_TRACING
+
+namespace tracing {
+    int64_t nowNs();
+    void record(const char* name, int64_t start_ns, int64_t end_ns);
+    void setThreadJob(int job_id);
+    int getThreadJob();
+    // Moves the spans of the job (0 for spans outside of jobs) out of the thread buffers into a file
+    void writeTrace(int job_id);
+
+    class Span {
+        public:
+            explicit Span(const char* name) : name(name), start_ns(nowNs()) {}
+            ~Span() { record(name, start_ns, nowNs()); }
+            Span(const Span&) = delete;
+            Span& operator=(const Span&) = delete;
+
+        private:
+            const char* name;
+            int64_t start_ns;
+    };
+
+    class JobScope {
+        public:
+            JobScope(int job_id, bool owner) : job_id(job_id), owner(owner), previous(getThreadJob()) { setThreadJob(job_id); }
+            ~JobScope() {
+                setThreadJob(previous);
+                if (owner) {
+                    writeTrace(job_id);
+                }
+            }
+            JobScope(const JobScope&) = delete;
+            JobScope& operator=(const JobScope&) = delete;
+
+        private:
+            int job_id;
+            bool owner;
+            int previous;
+    };
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SPAN(name) tracing::Span TRACE_CONCAT(trace_span_, __LINE__)(name)
+#define TRACE_JOB(job_id) tracing::JobScope TRACE_CONCAT(trace_job_, __LINE__)(job_id, true)
+#define TRACE_THREAD(job_id) tracing::JobScope TRACE_CONCAT(trace_thread_, __LINE__)(job_id, false)
+#define TRACE_FLUSH() tracing::writeTrace(0)
+
+#else
+
+#define TRACE_SPAN(name) do {} while (0)
+#define TRACE_JOB(job_id) do {} while (0)
+#define TRACE_THREAD(job_id) do {} while (0)
+#define TRACE_FLUSH() do {} while (0)
+
+#endif
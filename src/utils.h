@@ -3,6 +3,8 @@
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 #include "gurobi_c++.h"
+#include "model_arrays.h"
+#include "sampler.h"
 #include <random>
 #include <algorithm>
 
@@ -17,20 +19,9 @@ inline string convertVectorToString(vector<int>& solution) {
 // Sample without replacement from the set {0, 1, ..., n-1}
 // Returns a vector of sample_size integers sampled uniformly without replacement
 inline vector<int> sample_without_replacement(int n, int sample_size, mt19937& rng) {
-
-    // Create vector with elements {0, 1, ..., n-1}
-    vector<int> population;
-    population.reserve(n);
-    for (int i = 0; i < n; i++) {
-        population.push_back(i);
-    }
-    
-    // Shuffle the entire vector
-    shuffle(population.begin(), population.end(), rng);
-    
-    // Take the first sample_size elements
-    population.resize(sample_size);
-    return population;
+    // Scratch buffers are reused by the LNS iterations of a worker thread
+    thread_local Sampler sampler;
+    return sampler.sample(n, sample_size, rng);
 }
 
 inline vector<int> sample_percentage(int n, double percentage, mt19937& rng) {
@@ -51,13 +42,21 @@ inline vector<int> sample_percentage(int n, double percentage, int seed) {
 
 // A solution is a vector of indices for the non zero variables 
 inline vector<int> get_best_solution_from_model(GRBModel& model, vector<GRBVar>& binary_variables, double tolerance = 0.001) {
+    vector<double> values = getAttrArray(model, GRB_DoubleAttr_X, binary_variables.data(), binary_variables.size());
     vector<int> solution;
-    for (int i = 0; i < binary_variables.size(); i++) {
-      GRBVar var = binary_variables[i];
-      double value = var.get(GRB_DoubleAttr_X);
-      if (value > tolerance) {
+    for (int i = 0; i < values.size(); i++) {
+      if (values[i] > tolerance) {
         solution.push_back(i);
       }
     } 
     return solution;
   }
+
+// Dense 0/1 values over the binary variables from a list of one indices
+inline vector<double> solution_to_values(const vector<int>& solution, int num_binary_variables) {
+    vector<double> values(num_binary_variables, 0.0);
+    for (int var_index : solution) {
+        values[var_index] = 1.0;
+    }
+    return values;
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "db.h"
+
+using namespace std;
+
+// Binary encoding of the database records exchanged between the coordinator and its
+// workers (distributed.h). Scalars are copied in host byte order, so every host of a
+// campaign must be little endian (x86-64 and arm64 are). Strings, blobs and vectors
+// are prefixed with their length.
+class WireWriter {
+    public:
+        vector<char> buffer;
+
+        template <class T>
+        void putScalar(T value) {
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+        }
+        void put(bool value) { putScalar<uint8_t>(value); }
+        void put(int32_t value) { putScalar(value); }
+        void put(int64_t value) { putScalar(value); }
+        void put(float value) { putScalar(value); }
+        void put(double value) { putScalar(value); }
+        void put(const string& value) {
+            putScalar<int64_t>(value.size());
+            buffer.insert(buffer.end(), value.begin(), value.end());
+        }
+        void put(const vector<char>& value) {
+            putScalar<int64_t>(value.size());
+            buffer.insert(buffer.end(), value.begin(), value.end());
+        }
+        void put(const vector<int>& value) {
+            putScalar<int64_t>(value.size());
+            const char* bytes = reinterpret_cast<const char*>(value.data());
+            buffer.insert(buffer.end(), bytes, bytes + value.size() * sizeof(int));
+        }
+
+        template <class... T>
+        void operator()(const T&... values) {
+            (put(values), ...);
+        }
+};
+
+// Throws runtime_error when the message is shorter than its fields
+class WireReader {
+    public:
+        WireReader(const vector<char>& buffer) : position(buffer.data()), end(buffer.data() + buffer.size()) {}
+
+        template <class T>
+        T getScalar() {
+            T value;
+            take(&value, sizeof(T));
+            return value;
+        }
+        void get(bool& value) { value = getScalar<uint8_t>() != 0; }
+        void get(int32_t& value) { value = getScalar<int32_t>(); }
+        void get(int64_t& value) { value = getScalar<int64_t>(); }
+        void get(float& value) { value = getScalar<float>(); }
+        void get(double& value) { value = getScalar<double>(); }
+        void get(string& value) {
+            value.resize(getSize(1));
+            take(value.data(), value.size());
+        }
+        void get(vector<char>& value) {
+            value.resize(getSize(1));
+            take(value.data(), value.size());
+        }
+        void get(vector<int>& value) {
+            value.resize(getSize(sizeof(int)));
+            take(value.data(), value.size() * sizeof(int));
+        }
+
+        template <class... T>
+        void operator()(T&... values) {
+            (get(values), ...);
+        }
+
+    private:
+        const char* position;
+        const char* end;
+
+        void take(void* destination, size_t size) {
+            if (end - position < (ptrdiff_t)size) {
+                throw runtime_error("Truncated message");
+            }
+            memcpy(destination, position, size);
+            position += size;
+        }
+        size_t getSize(size_t element_size) {
+            int64_t size = getScalar<int64_t>();
+            if (size < 0 || size > (end - position) / (int64_t)element_size) {
+                throw runtime_error("Truncated message");
+            }
+            return size;
+        }
+};
+
+// Field lists of the records, shared by encoding and decoding
+template <class Archive, class T>
+void wireFields(Archive& archive, T& job, const Job*) {
+    archive(job.id, job.instance_id, job.time_limit_s, job.group_name, job.enable_callback,
+        job.metrics_every_nodes, job.metrics_every_ms, job.warm_start, job.enable_lns, job.seed,
+        job.fixing_ratio, job.iterative_lns, job.sub_mip_time_s, job.fixing_method, job.adaptive_lns,
+        job.neighborhood, job.lns_helpers, job.stall_time_s, job.stall_nodes, job.min_gap_rate,
+        job.stop_at_best_known, job.threads, job.cpu_set, job.numa_node, job.limit_type, job.limit_value, job.race_id, job.created_at, job.status, job.params_key,
+        job.worker_id, job.lease_expires_at, job.heartbeat_at, job.attempts);
+}
+
+template <class Archive, class T>
+void wireFields(Archive& archive, T& attributes, const GRBAttributes*) {
+    archive(attributes.id, attributes.job_id, attributes.MIPGap, attributes.PrimalGap, attributes.Runtime,
+        attributes.SolCount, attributes.NodeCount, attributes.Status, attributes.ObjVal, attributes.MaxMemUsed,
+        attributes.NumVars, attributes.NumConstrs, attributes.NumBinVars, attributes.NumIntVars,
+        attributes.Work, attributes.IterCount, attributes.BarIterCount, attributes.solution, attributes.solution_blob, attributes.winner, attributes.primal_gap_ref,
+        attributes.primal_integral, attributes.time_to_first_s, attributes.time_to_target_s,
+        attributes.termination_reason, attributes.cpu_user_s, attributes.cpu_sys_s, attributes.thread_cpu_s,
+        attributes.peak_rss_mb, attributes.peak_rss_delta_mb, attributes.minor_faults, attributes.major_faults);
+}
+
+template <class Archive, class T>
+void wireFields(Archive& archive, T& timeline, const IncumbentTimeline*) {
+    archive(timeline.job_id, timeline.num_events, timeline.timeline_blob);
+}
+
+template <class Archive, class T>
+void wireFields(Archive& archive, T& iteration, const LNSIteration*) {
+    archive(iteration.id, iteration.job_id, iteration.iteration, iteration.neighborhood_size, iteration.num_fixed,
+        iteration.sub_mip_time_s, iteration.status, iteration.fixing_time_ms, iteration.obj_val,
+        iteration.best_obj_val, iteration.improved, iteration.elapsed_ms, iteration.operator_name, iteration.work);
+}
+
+template <class Archive, class T>
+void wireFields(Archive& archive, T& op_stats, const LNSOperatorStats*) {
+    archive(op_stats.id, op_stats.job_id, op_stats.operator_name, op_stats.selections, op_stats.improvements,
+        op_stats.total_gain, op_stats.total_time_s, op_stats.value);
+}
+
+template <class Archive, class T>
+void wireFields(Archive& archive, T& metric, const CallbackMetric*) {
+    archive(metric.id, metric.job_id, metric.non_zero_count, metric.phase, metric.solcnt, metric.elapsed_ms);
+}
+
+template <class Archive, class T>
+void wireFields(Archive& archive, T& instance, const Instance*) {
+    archive(instance.id, instance.name, instance.created_at, instance.selected, instance.num_bin_variables,
+        instance.num_int_variables, instance.best_known_obj_val);
+}
+
+template <class T>
+void putRecord(WireWriter& writer, const T& record) {
+    wireFields(writer, record, (const T*)nullptr);
+}
+
+template <class T>
+void getRecord(WireReader& reader, T& record) {
+    wireFields(reader, record, (const T*)nullptr);
+}
+
+template <class T>
+void putRecords(WireWriter& writer, const vector<T>& records) {
+    writer.put((int64_t)records.size());
+    for (const T& record : records) {
+        putRecord(writer, record);
+    }
+}
+
+template <class T>
+void getRecords(WireReader& reader, vector<T>& records) {
+    int64_t size = reader.getScalar<int64_t>();
+    if (size < 0) {
+        throw runtime_error("Truncated message");
+    }
+    records.clear();
+    for (int64_t i = 0; i < size; i++) {
+        records.emplace_back();
+        getRecord(reader, records.back());
+    }
+}